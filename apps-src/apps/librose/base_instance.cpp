@@ -659,6 +659,7 @@ int base_instance::show_preferences_dialog(display& disp, bool first)
 void base_instance::clear_textures()
 {
 	gui2::clear_textures();
+	gui2::tcanvas::flush_cache();
 	image::flush_cache(true);
 }
 
@@ -20,6 +20,8 @@
 #include "wml_exception.hpp"
 #include "base_controller.hpp"
 
+#include <algorithm>
+
 #define index(x, y)  (w_ * (y) + (x))
 
 base_map::base_map(base_controller& controller, const tmap& gmap, bool consistent) 
@@ -383,6 +385,77 @@ void base_map::place(const map_location loc, base_unit* u)
 	}
 }
 
+static bool compare_map_index(const base_unit* a, const base_unit* b)
+{
+	return a->sort_compare(*b);
+}
+
+void base_map::relocate(const std::vector<std::pair<map_location, base_unit*> >& placements)
+{
+	display* disp = display::get_singleton();
+	std::vector<std::pair<map_location, base_unit*> > moving;
+	bool require_sort = false;
+
+	// 1. remove cookies of units that will move. must finish before placing any, target may be other's old location.
+	for (std::vector<std::pair<map_location, base_unit*> >::const_iterator it = placements.begin(); it != placements.end(); ++ it) {
+		base_unit* u = it->second;
+		const map_location& loc = it->first;
+		VALIDATE(loc.x >= 0 && loc.x < w_ && loc.y >= 0 && loc.y < h_, null_str);
+
+		const bool in_map = u->map_index_ >= 0 && u->map_index_ < map_vsize_ && map_[u->map_index_] == u;
+		if (in_map && u->get_location() == loc) {
+			continue;
+		}
+		if (in_map) {
+			const std::set<map_location>& touch_locs = u->get_touch_locations();
+			for (std::set<map_location>::const_iterator itor = touch_locs.begin(); itor != touch_locs.end(); ++ itor) {
+				loc_cookie& cookie = coor_map_[index(itor->x, itor->y)];
+				if (cookie.base == u) {
+					cookie.base = nullptr;
+				}
+				if (cookie.overlay == u) {
+					cookie.overlay = nullptr;
+				}
+			}
+			if (disp) {
+				disp->invalidate(u->get_draw_locations());
+			}
+		} else {
+			VALIDATE(map_vsize_ < map_size_, null_str);
+			u->map_index_ = map_vsize_;
+			map_[map_vsize_ ++] = u;
+		}
+		moving.push_back(*it);
+	}
+
+	// 2. place them.
+	for (std::vector<std::pair<map_location, base_unit*> >::const_iterator it = moving.begin(); it != moving.end(); ++ it) {
+		base_unit* u = it->second;
+		const bool base = u->base();
+		u->set_location(it->first);
+
+		const std::set<map_location>& touch_locs = u->get_touch_locations();
+		for (std::set<map_location>::const_iterator itor = touch_locs.begin(); itor != touch_locs.end(); ++ itor) {
+			if (base) {
+				coor_map_[index(itor->x, itor->y)].base = u;
+			} else {
+				coor_map_[index(itor->x, itor->y)].overlay = u;
+			}
+		}
+		if (disp) {
+			disp->invalidate(u->get_draw_locations());
+		}
+		require_sort |= u->require_sort();
+	}
+
+	if (require_sort) {
+		std::stable_sort(map_, map_ + map_vsize_, compare_map_index);
+		for (int i = 0; i < map_vsize_; i ++) {
+			map_[i]->map_index_ = i;
+		}
+	}
+}
+
 // Notice: caller must make sure loc of parameter is centor location of desired erase unit!
 bool base_map::erase(const map_location& loc, bool overlay)
 {
@@ -242,6 +242,9 @@ public:
 	virtual base_unit* extract(const map_location& loc);
 	virtual void place(const map_location loc, base_unit* u);
 
+	// batch version of insert/place. unit that is already at its location isn't touched, map_ is sorted once.
+	void relocate(const std::vector<std::pair<map_location, base_unit*> >& placements);
+
 	bool valid2(const map_location& loc, bool overlay) const;
 
 	virtual size_t units_from_rect(base_unit** draw_area_unit, const rect_of_hexes& draw_area_rect);
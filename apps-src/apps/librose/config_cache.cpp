@@ -609,7 +609,7 @@ bool teditor_::cfgs_2_cfg(const BIN_TYPE type, const std::string& name, const st
 
 			if (write_file) {
 				const std::string xwml_app_path = working_dir_ + "/xwml/" + game_config::generate_app_dir(app);
-				SDL_MakeDirectory(xwml_app_path.c_str());
+				make_directory(xwml_app_path);
 				wml_config_to_file(xwml_app_path + "/" + name, refcfg, nfiles, sum_size, modified, app_domains);
 			}
 
@@ -296,6 +296,7 @@ void display::release_theme()
 		delete dlg_;
 		dlg_ = nullptr;
 	}
+	gui2::tcanvas::flush_cache();
 	image::flush_cache();
 }
 
@@ -449,6 +449,99 @@ void dump_events(const std::vector<SDL_Event>& events)
 	posix_print("%s\n", ss.str().c_str());
 }
 
+static tpump_policy pump_policy_;
+// events exceed max_events in previous pump.
+static std::vector<SDL_Event> deferred_events;
+
+void set_pump_policy(const tpump_policy& policy)
+{
+	VALIDATE(policy.max_events >= 0, null_str);
+	pump_policy_ = policy;
+}
+
+const tpump_policy& pump_policy()
+{
+	return pump_policy_;
+}
+
+// merge event to last if both are same motion/wheel. return true if merged.
+static bool coalesce_event(SDL_Event& last, const SDL_Event& event)
+{
+	if (last.type != event.type) {
+		return false;
+	}
+	if (event.type == SDL_MOUSEMOTION) {
+		if (!pump_policy_.coalesce_motion || last.motion.which != event.motion.which 
+			|| last.motion.windowID != event.motion.windowID || last.motion.state != event.motion.state) {
+			return false;
+		}
+		const int xrel = last.motion.xrel + event.motion.xrel;
+		const int yrel = last.motion.yrel + event.motion.yrel;
+		last.motion = event.motion;
+		last.motion.xrel = xrel;
+		last.motion.yrel = yrel;
+		return true;
+
+	} else if (event.type == SDL_FINGERMOTION) {
+		if (!pump_policy_.coalesce_motion || last.tfinger.touchId != event.tfinger.touchId || last.tfinger.fingerId != event.tfinger.fingerId) {
+			return false;
+		}
+		const float dx = last.tfinger.dx + event.tfinger.dx;
+		const float dy = last.tfinger.dy + event.tfinger.dy;
+		last.tfinger = event.tfinger;
+		last.tfinger.dx = dx;
+		last.tfinger.dy = dy;
+		return true;
+
+	} else if (event.type == SDL_MOUSEWHEEL) {
+		if (!pump_policy_.coalesce_wheel || last.wheel.which != event.wheel.which
+			|| last.wheel.windowID != event.wheel.windowID || last.wheel.direction != event.wheel.direction) {
+			return false;
+		}
+		last.wheel.x += event.wheel.x;
+		last.wheel.y += event.wheel.y;
+		last.wheel.timestamp = event.wheel.timestamp;
+		return true;
+	}
+	return false;
+}
+
+static bool is_motion_event(const SDL_Event& event)
+{
+	return event.type == SDL_MOUSEMOTION || event.type == SDL_FINGERMOTION;
+}
+
+static bool is_same_motion_source(const SDL_Event& a, const SDL_Event& b)
+{
+	if (a.type != b.type) {
+		return false;
+	}
+	if (a.type == SDL_MOUSEMOTION) {
+		return a.motion.which == b.motion.which;
+	}
+	return a.tfinger.touchId == b.tfinger.touchId && a.tfinger.fingerId == b.tfinger.fingerId;
+}
+
+// on android/ios, every move sends SDL_FINGERMOTION and synthesized SDL_MOUSEMOTION(SDL_TOUCH_MOUSEID),
+// so motion is merged into latest motion of same device/finger, skipping motion of the other kind.
+// any non-motion event stops it, order relative to press/release is kept.
+static bool coalesce_to_events(std::vector<SDL_Event>& events, const SDL_Event& event)
+{
+	if (events.empty()) {
+		return false;
+	}
+	if (!is_motion_event(event)) {
+		return coalesce_event(events.back(), event);
+	}
+	for (std::vector<SDL_Event>::reverse_iterator it = events.rbegin(); it != events.rend() && is_motion_event(*it); ++ it) {
+		if (is_same_motion_source(*it, event)) {
+			// ex: button state changed, can not skip over it.
+			return coalesce_event(*it, event);
+		}
+	}
+	return false;
+}
+
 void pump()
 {
 	if (instance->terminating()) {
@@ -457,19 +550,22 @@ void pump()
 	}
 
 	SDL_Event temp_event;
-	int poll_count = 0;
 	int begin_ignoring = 0;
 
 	std::vector<SDL_Event> events;
+	events.swap(deferred_events);
+
 	// ignore user input events when receive SDL_WINDOWEVENT. include before and after.
 	while (SDL_PollEvent(&temp_event)) {
-		++ poll_count;
 		if (!begin_ignoring && temp_event.type == SDL_WINDOWEVENT) {
-			begin_ignoring = poll_count;
+			begin_ignoring = events.size() + 1;
 		} else if (begin_ignoring > 0 && temp_event.type >= INPUT_MASK_MIN && temp_event.type <= INPUT_MASK_MAX) {
 			//ignore user input events that occurred after the window was activated
 			continue;
 		}
+		if (coalesce_to_events(events, temp_event)) {
+			continue;
+		}
 		events.push_back(temp_event);
 	}
 
@@ -488,6 +584,11 @@ void pump()
 		}
 	}
 
+	if (pump_policy_.max_events && (int)events.size() > pump_policy_.max_events) {
+		deferred_events.assign(events.begin() + pump_policy_.max_events, events.end());
+		events.resize(pump_policy_.max_events);
+	}
+
 	std::vector<SDL_Event>::iterator ev_end = events.end();
 	for (ev_it = events.begin(); ev_it != ev_end; ++ev_it){
 		SDL_Event& event = *ev_it;
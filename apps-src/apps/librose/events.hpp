@@ -133,6 +133,26 @@ namespace events
 //causes events to be dispatched to all handler objects.
 void pump();
 
+// how pump() treats a burst of queued events.
+struct tpump_policy
+{
+	tpump_policy()
+		: coalesce_motion(true)
+		, coalesce_wheel(true)
+		, max_events(64)
+	{}
+
+	// consecutive SDL_MOUSEMOTION/SDL_FINGERMOTION merge into one: last position, summed delta.
+	bool coalesce_motion;
+	// consecutive SDL_MOUSEWHEEL merge into one: summed x/y.
+	bool coalesce_wheel;
+	// events dispatched in one pump, the rest are deferred to next pump. 0 means no limit.
+	int max_events;
+};
+
+void set_pump_policy(const tpump_policy& policy);
+const tpump_policy& pump_policy();
+
 class pump_monitor {
 //pump_monitors receive notifcation after an events::pump() occurs
 public:
@@ -43,6 +43,12 @@
 #else
 #include <sys/vfs.h> // statfs 
 #endif
+#include <sys/stat.h>
+#include <sys/time.h> // utimes
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/sendfile.h> // sendfile
+#endif
 #endif /* !_WIN32 */
 
 // for getenv
@@ -68,6 +74,7 @@
 #include "version.hpp"
 #include "wml_exception.hpp"
 #include "theme.hpp"
+#include "thread.hpp"
 
 #include <boost/foreach.hpp>
 #include <boost/bind.hpp>
@@ -102,6 +109,26 @@ bool ends_with(const std::string& str, const std::string& suffix)
 	return str.size() >= suffix.size() && std::equal(suffix.begin(),suffix.end(),str.end()-suffix.size());
 }
 
+static bool is_filtered_dir(const std::string& basename, int filter)
+{
+	if ((filter & SKIP_MEDIA_DIR) && (basename == "images"|| basename == "sounds" || basename == "music")) {
+		return true;
+	}
+	if ((filter & SKIP_SCENARIO_DIR) && (basename == "scenarios"|| basename == "maps" || basename == "music")) {
+		return true;
+	}
+	if ((filter & SKIP_GUI_DIR) && basename == "gui") {
+		return true;
+	}
+	if ((filter & SKIP_INTERNAL_DIR) && basename == "units-internal") {
+		return true;
+	}
+	if ((filter & SKIP_BOOK) && basename == "book") {
+		return true;
+	}
+	return false;
+}
+
 void get_files_in_dir(const std::string &directory,
 					  std::vector<std::string>* files,
 					  std::vector<std::string>* dirs,
@@ -163,19 +190,7 @@ void get_files_in_dir(const std::string &directory,
 		}
 
 		if (SDL_DIRENT_DIR(entry->mode)) {
-			if ((filter & SKIP_MEDIA_DIR) && (basename == "images"|| basename == "sounds" || basename == "music")) {
-				continue;
-			}
-			if ((filter & SKIP_SCENARIO_DIR) && (basename == "scenarios"|| basename == "maps" || basename == "music")) {
-				continue;
-			}
-			if ((filter & SKIP_GUI_DIR) && basename == "gui") {
-				continue;
-			}
-			if ((filter & SKIP_INTERNAL_DIR) && basename == "units-internal") {
-				continue;
-			}
-			if ((filter & SKIP_BOOK) && basename == "book") {
+			if (is_filtered_dir(basename, filter)) {
 				continue;
 			}
 
@@ -315,6 +330,7 @@ std::string get_dir(const std::string& dir_path)
 		return dir_path;
 	}
 	if (SDL_MakeDirectory(dir_path.c_str())) {
+		invalidate_dir_index(dir_path);
 		return dir_path;
 	}
 	return null_str;
@@ -325,7 +341,9 @@ std::string get_dir(const std::string& dir_path)
 bool delete_directory(const std::string& path)
 {
 #ifdef _WIN32
-	return SDL_DeleteFiles(path.c_str());
+	const bool fok = SDL_DeleteFiles(path.c_str())? true: false;
+	invalidate_dir_index(path);
+	return fok;
 #endif
 
 	bool ret = true;
@@ -356,6 +374,7 @@ bool delete_directory(const std::string& path)
 		LOG_FS << "remove(" << path << "): " << strerror(errno) << "\n";
 		ret = false;
 	}
+	invalidate_dir_index(path);
 	return ret;
 }
 
@@ -402,6 +421,7 @@ bool create_directory_if_missing(const std::string& dirname)
 		return false;
 	}
 
+	invalidate_dir_index(dirname);
 	return SDL_MakeDirectory(dirname.c_str());
 }
 
@@ -701,6 +721,7 @@ void write_file(const std::string& fname, const char* data, int len)
 	}
 	posix_fwrite(fp, data, len);
 	posix_fclose(fp);
+	invalidate_dir_index(fname);
 }
 
 std::string read_map(const std::string& name)
@@ -818,15 +839,197 @@ bool file_tree_checksum::operator==(const file_tree_checksum &rhs) const
 		modified == rhs.modified;
 }
 
-static void get_file_tree_checksum_internal(const std::string& path, file_tree_checksum& res, int filter)
+// scan one directory of tree, append sub-directories to @subdirs, and accumulate files to @checksum.
+static void scan_tree_dir(const std::string& dir, int filter, std::vector<std::string>& subdirs, file_tree_checksum& checksum)
 {
+	// reuse this buffer to form sub-directory.
+	std::string path = dir;
+	if (path.empty() || path[path.size() - 1] != '/') {
+		path.push_back('/');
+	}
+	const size_t prefix_size = path.size();
 
-	std::vector<std::string> dirs;
-	get_files_in_dir(path,NULL,&dirs, ENTIRE_FILE_PATH, filter, DONT_REORDER, &res);
-	loadscreen::increment_progress();
+#ifdef __linux__
+	int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+	if (fd < 0) {
+		return;
+	}
+	DIR* handle = fdopendir(fd);
+	if (!handle) {
+		close(fd);
+		return;
+	}
+	struct dirent* entry;
+	struct stat st;
+	while ((entry = readdir(handle))) {
+		if (entry->d_name[0] == '.') {
+			continue;
+		}
+		bool isdir = entry->d_type == DT_DIR;
+		if (!isdir) {
+			// directory of d_type is reliable, don't stat it. stat relative to directory fd.
+			if (fstatat(fd, entry->d_name, &st, 0)) {
+				continue;
+			}
+			isdir = S_ISDIR(st.st_mode);
+		}
+		if (isdir) {
+			if (!is_filtered_dir(entry->d_name, filter)) {
+				path.resize(prefix_size);
+				path.append(entry->d_name);
+				subdirs.push_back(path);
+			}
+		} else {
+			if (st.st_mtime > checksum.modified) {
+				checksum.modified = st.st_mtime;
+			}
+			checksum.sum_size += st.st_size;
+			checksum.nfiles ++;
+		}
+	}
+	// closedir close fd also.
+	closedir(handle);
+
+#else
+	SDL_DIR* handle = SDL_OpenDir(dir.c_str());
+	if (!handle) {
+		return;
+	}
+	SDL_dirent2* entry;
+	while ((entry = SDL_ReadDir(handle))) {
+		if (entry->name[0] == '.') {
+			continue;
+		}
+		if (SDL_DIRENT_DIR(entry->mode)) {
+			if (!is_filtered_dir(entry->name, filter)) {
+				path.resize(prefix_size);
+				path.append(entry->name);
+				subdirs.push_back(path);
+			}
+		} else {
+			if (entry->mtime > checksum.modified) {
+				checksum.modified = entry->mtime;
+			}
+			checksum.sum_size += entry->size;
+			checksum.nfiles ++;
+		}
+	}
+	SDL_CloseDir(handle);
+#endif
+}
+
+// walk directory trees by multi-thread. every thread pick directory from shared queue, 
+// and push sub-directories back to it, so thread that finished shallow directory can take over deep one.
+class ttree_walker
+{
+public:
+	explicit ttree_walker(int filter)
+		: filter_(filter)
+		, busy_(0)
+	{}
+
+	void walk(const std::vector<std::string>& roots, file_tree_checksum& checksum);
+
+private:
+	struct tworker {
+		tworker(ttree_walker& walker)
+			: walker(&walker)
+			, thread(NULL)
+		{}
+
+		ttree_walker* walker;
+		SDL_Thread* thread;
+		file_tree_checksum checksum;
+	};
+
+	static int SDLCALL thread_func(void* param);
+	void work(file_tree_checksum& checksum, bool main_thread);
+
+private:
+	const int filter_;
+	threading::mutex mutex_;
+	threading::condition cond_;
+	std::vector<std::string> pending_;
+	// how many threads are scanning directory. they maybe push more directories.
+	int busy_;
+};
+
+int SDLCALL ttree_walker::thread_func(void* param)
+{
+	tworker& worker = *(tworker*)param;
+	worker.walker->work(worker.checksum, false);
+	return 0;
+}
+
+void ttree_walker::work(file_tree_checksum& checksum, bool main_thread)
+{
+	std::vector<std::string> subdirs;
+	std::string dir;
+	while (true) {
+		{
+			threading::lock lock(mutex_);
+			while (pending_.empty() && busy_) {
+				cond_.wait(mutex_);
+			}
+			if (pending_.empty()) {
+				// no directory and no one is scanning, walk finished.
+				return;
+			}
+			dir = pending_.back();
+			pending_.pop_back();
+			busy_ ++;
+		}
+
+		subdirs.clear();
+		scan_tree_dir(dir, filter_, subdirs, checksum);
+		if (main_thread) {
+			loadscreen::increment_progress();
+		}
+
+		{
+			threading::lock lock(mutex_);
+			pending_.insert(pending_.end(), subdirs.begin(), subdirs.end());
+			busy_ --;
+			cond_.notify_all();
+		}
+	}
+}
+
+void ttree_walker::walk(const std::vector<std::string>& roots, file_tree_checksum& checksum)
+{
+	for (std::vector<std::string>::const_iterator it = roots.begin(); it != roots.end(); ++ it) {
+		const std::string& root = *it;
+		// same as get_files_in_dir, relative path is rooted on game_config::path.
+		std::string path = SDL_IsRootPath(root.c_str())? root: game_config::path + "/" + root;
+		if (is_directory(path)) {
+			pending_.push_back(path);
+		}
+	}
+	if (pending_.empty()) {
+		return;
+	}
+
+	const int max_threads = 8;
+	const int nthreads = SDL_min(SDL_GetCPUCount(), max_threads) - 1;
+	std::vector<tworker> workers(SDL_max(nthreads, 0), tworker(*this));
+	for (std::vector<tworker>::iterator it = workers.begin(); it != workers.end(); ++ it) {
+		it->thread = SDL_CreateThread(thread_func, "tree_walker", &*it);
+	}
 
-	for (std::vector<std::string>::const_iterator j = dirs.begin(); j != dirs.end(); ++j) {
-		get_file_tree_checksum_internal(*j, res, filter);
+	work(checksum, true);
+
+	// merge in worker order. nfiles/sum_size are sums, modified is max, so result doesn't depend on schedule.
+	for (std::vector<tworker>::const_iterator it = workers.begin(); it != workers.end(); ++ it) {
+		const tworker& worker = *it;
+		if (!worker.thread) {
+			continue;
+		}
+		SDL_WaitThread(worker.thread, NULL);
+		checksum.nfiles += worker.checksum.nfiles;
+		checksum.sum_size += worker.checksum.sum_size;
+		if (worker.checksum.modified > checksum.modified) {
+			checksum.modified = worker.checksum.modified;
+		}
 	}
 }
 
@@ -836,8 +1039,11 @@ const file_tree_checksum& data_tree_checksum(bool reset, int filter)
 	if (reset)
 		checksum.reset();
 	if(checksum.nfiles == 0) {
-		get_file_tree_checksum_internal("data/", checksum, filter);
-		get_file_tree_checksum_internal(get_user_data_dir() + "/data/", checksum, filter);
+		std::vector<std::string> paths;
+		paths.push_back("data/");
+		paths.push_back(get_user_data_dir() + "/data/");
+		ttree_walker walker(filter);
+		walker.walk(paths, checksum);
 		LOG_FS << "calculated data tree checksum: "
 			   << checksum.nfiles << " files; "
 			   << checksum.sum_size << " bytes\n";
@@ -849,9 +1055,8 @@ const file_tree_checksum& data_tree_checksum(bool reset, int filter)
 void data_tree_checksum(const std::vector<std::string>& paths, file_tree_checksum& checksum, int filter)
 {
 	checksum.reset();
-	for (std::vector<std::string>::const_iterator it = paths.begin(); it != paths.end(); ++ it) {
-		get_file_tree_checksum_internal(*it, checksum, filter);
-	}
+	ttree_walker walker(filter);
+	walker.walk(paths, checksum);
 }
 
 std::string file_name(const std::string& file)
@@ -937,6 +1142,258 @@ std::string file_ext_name(const std::string& file)
 
 namespace {
 
+// content of one directory, used to answer existence without stat every candidate path.
+struct tdir_index
+{
+	tdir_index()
+		: exist(false)
+		, settled(false)
+		, mtime(0)
+		, verified_ticks(0)
+	{}
+
+	bool exist;
+	// directory modified just before scan, mtime's precision cannot tell later modify.
+	bool settled;
+	int64_t mtime;
+	uint32_t verified_ticks;
+	// name ==> is directory
+	std::map<std::string, bool> entries;
+};
+
+std::map<std::string, tdir_index> dir_indexes;
+SDL_SpinLock dir_indexes_lock = 0;
+// bumped when any directory index is dropped or its entries changed.
+SDL_atomic_t dir_index_generation_;
+// during this interval, think directory not changed, don't stat it.
+const uint32_t dir_index_verify_interval = 1000;
+
+enum {index_none, index_file, index_dir};
+}
+
+static void fold_index_name(std::string& name)
+{
+#if defined(_WIN32) || defined(__APPLE__)
+	// file system is case-insensitive.
+	std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+#endif
+}
+
+static int find_in_dir_index(const tdir_index& index, const std::string& name)
+{
+	std::map<std::string, bool>::const_iterator it = index.entries.find(name);
+	if (it == index.entries.end()) {
+		return index_none;
+	}
+	return it->second? index_dir: index_file;
+}
+
+static void scan_dir_index(const std::string& dir, tdir_index& index)
+{
+	SDL_DIR* handle = SDL_OpenDir(dir.c_str());
+	if (!handle) {
+		index.exist = false;
+		return;
+	}
+	SDL_dirent2* entry;
+	std::string name;
+	while ((entry = SDL_ReadDir(handle))) {
+		if (!SDL_strcmp(entry->name, ".") || !SDL_strcmp(entry->name, "..")) {
+			continue;
+		}
+		name = entry->name;
+		fold_index_name(name);
+		index.entries.insert(std::make_pair(name, SDL_DIRENT_DIR(entry->mode)? true: false));
+	}
+	SDL_CloseDir(handle);
+}
+
+static int lookup_dir_index(const std::string& path)
+{
+	size_t pos = path.rfind('/');
+	if (pos == std::string::npos || pos + 1 == path.size()) {
+		// not in form of <dir>/<name>, stat it directly.
+		if (SDL_IsFile(path.c_str())) {
+			return index_file;
+		}
+		return SDL_IsDirectory(path.c_str())? index_dir: index_none;
+	}
+	const std::string dir = pos? path.substr(0, pos): "/";
+	std::string name = path.substr(pos + 1);
+	fold_index_name(name);
+
+	const uint32_t now = SDL_GetTicks();
+	int ret = index_none;
+	bool hit = false;
+
+	SDL_AtomicLock(&dir_indexes_lock);
+	std::map<std::string, tdir_index>::iterator it = dir_indexes.find(dir);
+	if (it != dir_indexes.end() && now - it->second.verified_ticks < dir_index_verify_interval) {
+		ret = find_in_dir_index(it->second, name);
+		hit = true;
+	}
+	SDL_AtomicUnlock(&dir_indexes_lock);
+	if (hit) {
+		return ret;
+	}
+
+	// verify or build index. don't hold lock during io.
+	tdir_index index;
+	SDL_dirent st;
+	index.verified_ticks = now;
+	index.exist = SDL_GetStat(dir.c_str(), &st) && SDL_DIRENT_DIR(st.mode);
+	if (index.exist) {
+		index.mtime = st.mtime;
+		index.settled = st.mtime < time(NULL) - 1;
+	}
+
+	SDL_AtomicLock(&dir_indexes_lock);
+	it = dir_indexes.find(dir);
+	if (it != dir_indexes.end() && it->second.settled && it->second.exist == index.exist && it->second.mtime == index.mtime) {
+		it->second.verified_ticks = now;
+		ret = find_in_dir_index(it->second, name);
+		hit = true;
+	}
+	SDL_AtomicUnlock(&dir_indexes_lock);
+	if (hit) {
+		return ret;
+	}
+
+	if (index.exist) {
+		scan_dir_index(dir, index);
+	}
+	ret = find_in_dir_index(index, name);
+
+	SDL_AtomicLock(&dir_indexes_lock);
+	it = dir_indexes.find(dir);
+	if (it != dir_indexes.end()) {
+		if (it->second.exist != index.exist || it->second.entries != index.entries) {
+			SDL_AtomicIncRef(&dir_index_generation_);
+		}
+		std::swap(it->second, index);
+	} else {
+		std::swap(dir_indexes[dir], index);
+	}
+	SDL_AtomicUnlock(&dir_indexes_lock);
+
+	return ret;
+}
+
+bool indexed_file_exists(const std::string& name)
+{
+	if (name.empty()) {
+		return false;
+	}
+	return lookup_dir_index(name) == index_file;
+}
+
+bool indexed_exists(const std::string& name)
+{
+	if (name.empty()) {
+		return false;
+	}
+	return lookup_dir_index(name) != index_none;
+}
+
+void precache_dir_index(const std::string& dir)
+{
+	std::vector<std::string> dirs;
+	size_t size = dir.size();
+	while (size > 1 && dir[size - 1] == '/') {
+		size --;
+	}
+	const std::string key = dir.substr(0, size);
+	// lookup a name that never exist, it results in index of dir.
+	lookup_dir_index(key + "/.");
+
+	SDL_AtomicLock(&dir_indexes_lock);
+	std::map<std::string, tdir_index>::const_iterator find_it = dir_indexes.find(key);
+	if (find_it != dir_indexes.end()) {
+		const std::map<std::string, bool>& entries = find_it->second.entries;
+		for (std::map<std::string, bool>::const_iterator it = entries.begin(); it != entries.end(); ++ it) {
+			if (it->second) {
+				dirs.push_back(key + "/" + it->first);
+			}
+		}
+	}
+	SDL_AtomicUnlock(&dir_indexes_lock);
+
+	for (std::vector<std::string>::const_iterator it = dirs.begin(); it != dirs.end(); ++ it) {
+		precache_dir_index(*it);
+	}
+}
+
+void invalidate_dir_index(const std::string& name)
+{
+	size_t pos = name.find_last_not_of('/');
+	if (pos == std::string::npos) {
+		return;
+	}
+	// name maybe a directory that is deleted or replaced, drop index of it and its sub-directories too.
+	const std::string self = name.substr(0, pos + 1);
+	const std::string children = self + "/";
+	pos = name.rfind('/', pos);
+	if (pos == std::string::npos) {
+		return;
+	}
+	const std::string dir = pos? name.substr(0, pos): "/";
+
+	SDL_AtomicLock(&dir_indexes_lock);
+	dir_indexes.erase(dir);
+	dir_indexes.erase(self);
+	std::map<std::string, tdir_index>::iterator it = dir_indexes.lower_bound(children);
+	while (it != dir_indexes.end() && !it->first.compare(0, children.size(), children)) {
+		dir_indexes.erase(it ++);
+	}
+	SDL_AtomicUnlock(&dir_indexes_lock);
+	SDL_AtomicIncRef(&dir_index_generation_);
+}
+
+void clear_dir_index()
+{
+	SDL_AtomicLock(&dir_indexes_lock);
+	dir_indexes.clear();
+	SDL_AtomicUnlock(&dir_indexes_lock);
+	SDL_AtomicIncRef(&dir_index_generation_);
+}
+
+unsigned dir_index_generation()
+{
+	return SDL_AtomicGet(&dir_index_generation_);
+}
+
+bool copy_files(const std::string& src, const std::string& dst)
+{
+	const bool fok = SDL_CopyFiles(src.c_str(), dst.c_str())? true: false;
+	invalidate_dir_index(dst);
+	return fok;
+}
+
+bool delete_files(const std::string& path)
+{
+	const bool fok = SDL_DeleteFiles(path.c_str())? true: false;
+	invalidate_dir_index(path);
+	return fok;
+}
+
+bool rename_file(const std::string& src, const std::string& new_name)
+{
+	const bool fok = SDL_RenameFile(src.c_str(), new_name.c_str())? true: false;
+	invalidate_dir_index(src);
+	// new_name is in same directory as src.
+	invalidate_dir_index(src.substr(0, src.rfind('/') + 1) + new_name);
+	return fok;
+}
+
+bool make_directory(const std::string& path)
+{
+	const bool fok = SDL_MakeDirectory(path.c_str())? true: false;
+	invalidate_dir_index(path);
+	return fok;
+}
+
+namespace {
+
 #define PRIORITIEST_BINARY_PATHS	1
 std::vector<std::string> binary_paths;
 
@@ -1065,12 +1522,12 @@ std::string get_binary_file_location(const std::string& type, const std::string&
 			// if maybe require theme special, priority get it.
 			std::string dir = directory_name2(file);
 			std::string file2 = dir + "/" + theme::instance.id + (file.c_str() + dir.size());
-			if (file_exists(file2)) {
+			if (indexed_file_exists(file2)) {
 				return file2;
 			}	
 		}
 
-		if (file_exists(file)) {
+		if (indexed_file_exists(file)) {
 			return file;
 		}
 	}
@@ -1136,7 +1593,7 @@ std::string get_wml_location(const std::string &filename, const std::string &cur
 		result = game_config::path + "/data/" + filename;
 	}
 
-	if (result.empty() || (!file_exists(result) && !is_directory(result))) {
+	if (result.empty() || !indexed_exists(result)) {
 		result.clear();
 	}
 
@@ -1181,7 +1638,9 @@ std::string get_hdpi_name(const std::string& name, int hdpi_scale)
 bool walk_dir(const std::string& rootdir, bool subfolders, const twalk_dir_function& fn)
 {
 	bool ret = true;
-	std::stringstream ss;
+	// reuse this buffer to form sub-directory.
+	std::string path = rootdir + "/";
+	const size_t prefix_size = path.size();
 	SDL_DIR* dir = SDL_OpenDir(rootdir.c_str());
 	if (!dir) {
 		return false;
@@ -1198,10 +1657,10 @@ bool walk_dir(const std::string& rootdir, bool subfolders, const twalk_dir_funct
 						break;
 					}
 				}
-				ss.str("");
-				ss << rootdir << "/" << dirent->name;
 				if (subfolders) {
-					walk_dir(ss.str(), true, fn);
+					path.resize(prefix_size);
+					path.append(dirent->name);
+					walk_dir(path, true, fn);
 				}
 			}
 		} else {
@@ -1254,6 +1713,7 @@ bool copy_root_files(const std::string& src, const std::string& dst, std::set<st
 		}
 	}
 	SDL_CloseDir(dir);
+	invalidate_dir_index(dst);
 
 	return ret? true: false;
 }
@@ -1338,6 +1798,325 @@ bool compare_directory(const std::string& dir1, const std::string& dir2)
 	return true;
 }
 
+// FNV-1a of file content. return false if cannot read it.
+static bool file_content_hash(const std::string& fname, uint32_t& hash)
+{
+	bool fok = false;
+	uint8_t* buf = NULL;
+	int64_t fsize, pos = 0;
+	const int buf_size = 64 * 1024;
+
+	hash = 2166136261u;
+	posix_file_t fp = INVALID_FILE;
+	posix_fopen(fname.c_str(), GENERIC_READ, OPEN_EXISTING, fp);
+	if (fp == INVALID_FILE) {
+		goto exit;
+	}
+	fsize = posix_fsize(fp);
+	buf = (uint8_t*)malloc(buf_size);
+	if (!buf) {
+		goto exit;
+	}
+	posix_fseek(fp, 0);
+	while (pos < fsize) {
+		int bytes = (int)posix_fread(fp, buf, buf_size);
+		if (bytes <= 0) {
+			goto exit;
+		}
+		for (int n = 0; n < bytes; n ++) {
+			hash = (hash ^ buf[n]) * 16777619u;
+		}
+		pos += bytes;
+	}
+	fok = true;
+exit:
+	if (buf) {
+		free(buf);
+	}
+	if (fp != INVALID_FILE) {
+		posix_fclose(fp);
+	}
+	return fok;
+}
+
+// set access/modify time of @dst to @src's.
+static bool copy_file_times(const std::string& src, const std::string& dst)
+{
+#ifdef _WIN32
+	std::wstring wsrc, wdst;
+	for (int n = 0; n < 2; n ++) {
+		const std::string& utf8 = n? dst: src;
+		std::wstring& wide = n? wdst: wsrc;
+		int wlen = MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, NULL, 0);
+		if (wlen <= 0) {
+			return false;
+		}
+		wide.resize(wlen);
+		MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, &wide[0], wlen);
+	}
+
+	FILETIME atime, mtime;
+	HANDLE h = CreateFileW(wsrc.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+	if (h == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	bool fok = GetFileTime(h, NULL, &atime, &mtime)? true: false;
+	CloseHandle(h);
+	if (!fok) {
+		return false;
+	}
+	h = CreateFileW(wdst.c_str(), FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+	if (h == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	fok = SetFileTime(h, NULL, &atime, &mtime)? true: false;
+	CloseHandle(h);
+	return fok;
+#else
+	struct stat st;
+	if (stat(src.c_str(), &st)) {
+		return false;
+	}
+	struct timeval times[2];
+	times[0].tv_sec = st.st_atime;
+	times[0].tv_usec = 0;
+	times[1].tv_sec = st.st_mtime;
+	times[1].tv_usec = 0;
+	return utimes(dst.c_str(), times) == 0;
+#endif
+}
+
+// copy one file. on linux, let kernel copy it (copy_file_range/sendfile), data don't pass user space.
+// mtime of @dst is set to @src's, sync_directory use size and mtime to tell it is same.
+static bool copy_single_file(const std::string& src, const std::string& dst)
+{
+#ifdef __linux__
+	struct stat st;
+	int in = open(src.c_str(), O_RDONLY);
+	if (in >= 0 && fstat(in, &st)) {
+		close(in);
+		in = -1;
+	}
+	if (in >= 0) {
+		const struct timespec times[2] = {st.st_atim, st.st_mtim};
+		int out = open(dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC, st.st_mode & 0777);
+		if (out >= 0) {
+			off_t left = st.st_size;
+			while (left > 0) {
+				ssize_t bytes;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+				bytes = copy_file_range(in, NULL, out, NULL, left, 0);
+				if (bytes < 0 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL)) {
+					bytes = sendfile(out, in, NULL, left);
+				}
+#else
+				bytes = sendfile(out, in, NULL, left);
+#endif
+				if (bytes <= 0) {
+					break;
+				}
+				left -= bytes;
+			}
+			const bool fok = !left && futimens(out, times) == 0;
+			close(out);
+			close(in);
+			if (fok) {
+				return true;
+			}
+			// kernel copy fail, fallback to SDL_CopyFiles.
+		} else {
+			close(in);
+		}
+		return SDL_CopyFiles(src.c_str(), dst.c_str()) && utimensat(AT_FDCWD, dst.c_str(), times, 0) == 0;
+	}
+#endif
+	return SDL_CopyFiles(src.c_str(), dst.c_str()) && copy_file_times(src, dst);
+}
+
+namespace {
+struct tsync_entry
+{
+	tsync_entry(const SDL_dirent2& dirent)
+		: dir(SDL_DIRENT_DIR(dirent.mode))
+		, size(dirent.size)
+		, mtime(dirent.mtime)
+	{}
+
+	bool dir;
+	int64_t size;
+	int64_t mtime;
+};
+
+struct tcopy_pool
+{
+	tcopy_pool(const std::vector<std::pair<std::string, std::string> >& jobs)
+		: jobs(jobs)
+	{
+		SDL_AtomicSet(&next, 0);
+		SDL_AtomicSet(&done, 0);
+		SDL_AtomicSet(&failed, 0);
+	}
+
+	const std::vector<std::pair<std::string, std::string> >& jobs;
+	SDL_atomic_t next;
+	// count of copied jobs, by all threads.
+	SDL_atomic_t done;
+	SDL_atomic_t failed;
+};
+}
+
+// key of @entries is relative path, begin with '/'. std::map make parent precede children.
+static bool cb_collect_sync_entries(const std::string& root, const std::string& dir, const SDL_dirent2* dirent, std::map<std::string, tsync_entry>& entries)
+{
+	entries.insert(std::make_pair(dir.substr(root.size()) + "/" + dirent->name, tsync_entry(*dirent)));
+	return true;
+}
+
+// return the job that this thread copied, -1 if no job.
+static int copy_next_file(tcopy_pool& pool)
+{
+	if (SDL_AtomicGet(&pool.failed)) {
+		return -1;
+	}
+	int at = SDL_AtomicAdd(&pool.next, 1);
+	if (at >= (int)pool.jobs.size()) {
+		return -1;
+	}
+	const std::pair<std::string, std::string>& job = pool.jobs[at];
+	if (!copy_single_file(job.first, job.second)) {
+		SDL_AtomicSet(&pool.failed, 1);
+		return -1;
+	}
+	SDL_AtomicIncRef(&pool.done);
+	return at;
+}
+
+// jobs are copied out of order, report by count, name is only for display.
+static void report_copy_progress(tcopy_pool& pool, int& reported)
+{
+	const int done = SDL_AtomicGet(&pool.done);
+	for (; reported < done; reported ++) {
+		increment_preprocessor_progress(pool.jobs[reported].first, true);
+	}
+}
+
+static int SDLCALL copy_files_thread(void* param)
+{
+	tcopy_pool& pool = *(tcopy_pool*)param;
+	while (copy_next_file(pool) >= 0);
+	return 0;
+}
+
+static bool sync_directory_internal(const std::string& src, const std::string& dst, bool hash)
+{
+	if (src.empty() || dst.empty() || !is_directory(src)) {
+		return false;
+	}
+
+	std::map<std::string, tsync_entry> src_entries, dst_entries;
+	if (!walk_dir(src, true, boost::bind(&cb_collect_sync_entries, boost::cref(src), _1, _2, boost::ref(src_entries)))) {
+		return false;
+	}
+	if (is_directory(dst)) {
+		if (!walk_dir(dst, true, boost::bind(&cb_collect_sync_entries, boost::cref(dst), _1, _2, boost::ref(dst_entries)))) {
+			return false;
+		}
+	} else {
+		SDL_DeleteFiles(dst.c_str());
+		if (!SDL_MakeDirectory(dst.c_str())) {
+			return false;
+		}
+	}
+
+	// 1. delete files/directories that src hasn't, or type is changed.
+	for (std::map<std::string, tsync_entry>::const_iterator it = dst_entries.begin(); it != dst_entries.end(); ++ it) {
+		const std::string& name = it->first;
+		const size_t pos = name.rfind('/');
+		if (pos) {
+			// parent directory isn't directory in src, it has been deleted with its children.
+			std::map<std::string, tsync_entry>::const_iterator parent_it = src_entries.find(name.substr(0, pos));
+			if (parent_it == src_entries.end() || !parent_it->second.dir) {
+				continue;
+			}
+		}
+		std::map<std::string, tsync_entry>::const_iterator find_it = src_entries.find(name);
+		if (find_it == src_entries.end() || find_it->second.dir != it->second.dir) {
+			if (!SDL_DeleteFiles((dst + name).c_str())) {
+				return false;
+			}
+		}
+	}
+
+	// 2. create directories, and collect files that require copy.
+	std::vector<std::pair<std::string, std::string> > jobs;
+	for (std::map<std::string, tsync_entry>::const_iterator it = src_entries.begin(); it != src_entries.end(); ++ it) {
+		const std::string& name = it->first;
+		const tsync_entry& entry = it->second;
+		const std::string dst_name = dst + name;
+		std::map<std::string, tsync_entry>::const_iterator find_it = dst_entries.find(name);
+		const bool exist = find_it != dst_entries.end() && find_it->second.dir == entry.dir;
+
+		if (entry.dir) {
+			if (!exist && !SDL_MakeDirectory(dst_name.c_str())) {
+				return false;
+			}
+			continue;
+		}
+		if (exist && find_it->second.size == entry.size) {
+			const bool same_mtime = find_it->second.mtime == entry.mtime;
+			uint32_t src_hash, dst_hash;
+			if (same_mtime && !hash) {
+				continue;
+			}
+			// mtime may be lost when copied by other tool or filesystem doesn't keep it.
+			// same content, fix mtime so that next sync needn't hash it again.
+			if (file_content_hash(src + name, src_hash) && file_content_hash(dst_name, dst_hash) && src_hash == dst_hash) {
+				if (!same_mtime) {
+					copy_file_times(src + name, dst_name);
+				}
+				continue;
+			}
+		}
+		jobs.push_back(std::make_pair(src + name, dst_name));
+	}
+	if (jobs.empty()) {
+		return true;
+	}
+
+	// 3. copy. main thread copy also, and it is responsible for progress.
+	tcopy_pool pool(jobs);
+	std::vector<SDL_Thread*> threads;
+	const int max_threads = 4;
+	const int nthreads = SDL_min(SDL_min(SDL_GetCPUCount(), max_threads), (int)jobs.size()) - 1;
+	for (int n = 0; n < nthreads; n ++) {
+		SDL_Thread* thread = SDL_CreateThread(copy_files_thread, "copy_files", &pool);
+		if (thread) {
+			threads.push_back(thread);
+		}
+	}
+	int reported = 0;
+	while (copy_next_file(pool) >= 0) {
+		report_copy_progress(pool, reported);
+	}
+	// other threads are copying at most one file every.
+	for (std::vector<SDL_Thread*>::const_iterator it = threads.begin(); it != threads.end(); ++ it) {
+		SDL_WaitThread(*it, NULL);
+	}
+	report_copy_progress(pool, reported);
+
+	return SDL_AtomicGet(&pool.failed)? false: true;
+}
+
+bool sync_directory(const std::string& src, const std::string& dst, bool hash)
+{
+	const bool fok = sync_directory_internal(src, dst, hash);
+	// even if fail, some files/directories in dst maybe changed.
+	if (!dst.empty()) {
+		invalidate_dir_index(dst);
+	}
+	return fok;
+}
+
 scoped_istream& scoped_istream::operator=(std::istream *s)
 {
 	delete stream;
@@ -1828,6 +2607,9 @@ tfile::tfile(const std::string& file, uint32_t desired_access, uint32_t create_d
 	VALIDATE(create_disposition == OPEN_EXISTING || create_disposition == CREATE_ALWAYS, null_str);
 	// CREATE_ALWAYS: create always. if file exist, it will truncate to 0 immediately.
 	posix_fopen(file.c_str(), desired_access, create_disposition, fp);
+	if (create_disposition == CREATE_ALWAYS) {
+		invalidate_dir_index(file);
+	}
 }
 
 void tfile::close()
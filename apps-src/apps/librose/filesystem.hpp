@@ -187,6 +187,10 @@ typedef boost::function<bool (const std::string& dir, const SDL_dirent2* dirent)
 bool walk_dir(const std::string& rootdir, bool subfolders, const twalk_dir_function& fn);
 bool copy_root_files(const std::string& src, const std::string& dst, std::set<std::string>* files);
 bool compare_directory(const std::string& dir1, const std::string& dir2);
+// make @dst same as @src. only copy files that size/mtime(and content when @hash is true) changed, files are copyed by multi-thread.
+// copied file keeps mtime of @src. when size is same but mtime differs, compare content, and fix mtime if same.
+// files/directories that @src hasn't will be deleted from @dst.
+bool sync_directory(const std::string& src, const std::string& dst, bool hash);
 
 /**
  *  The paths manager is responsible for recording the various paths
@@ -220,6 +224,31 @@ private:
 
 void clear_binary_paths_cache();
 
+/**
+ * Returns whether @a name is a file(or file/directory for indexed_exists),
+ * answered from index of its parent directory instead of stat it.
+ * Index of a directory is rebuilt when that directory's mtime changed.
+ */
+bool indexed_file_exists(const std::string& name);
+bool indexed_exists(const std::string& name);
+/** Builds index of @a dir and all its sub-directories ahead. */
+void precache_dir_index(const std::string& dir);
+/** Drops index of @a name's parent directory, and of @a name and its sub-directories when it is a directory. call it after create/delete/copy to @a name. */
+void invalidate_dir_index(const std::string& name);
+void clear_dir_index();
+/** Changes when any directory index is dropped or rebuilt with other entries, memo of lookups can compare it. */
+unsigned dir_index_generation();
+
+/**
+ * SDL_CopyFiles/SDL_DeleteFiles/SDL_RenameFile/SDL_MakeDirectory, and drop directory index of changed path.
+ * Use them instead of SDL_xxx when changed path maybe looked up by binary/wml path.
+ */
+bool copy_files(const std::string& src, const std::string& dst);
+bool delete_files(const std::string& path);
+// @new_name is name in same directory of @src.
+bool rename_file(const std::string& src, const std::string& new_name);
+bool make_directory(const std::string& path);
+
 /**
  * Returns a vector with all possible paths to a given type of binary,
  * e.g. 'images', 'sounds', etc,
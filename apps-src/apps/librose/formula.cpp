@@ -32,31 +32,91 @@ void formula_callable::set_value(const std::string& key, const variant& /*value*
 }
 
 
+static const char* slot_names[] = {"screen_width", "screen_height", "svga", "vga", "mobile",
+	"width", "height", "dwidth", "dheight", "extra_width", "extra_height",
+	"text"};
+
+static std::map<std::string, int> generate_slots()
+{
+	BOOST_STATIC_ASSERT(sizeof(slot_names) / sizeof(slot_names[0]) == slot_count);
+	BOOST_STATIC_ASSERT(slot_count <= 32);
+
+	std::map<std::string, int> result;
+	for (int n = 0; n < slot_count; n ++) {
+		result.insert(std::make_pair(slot_names[n], n));
+	}
+	return result;
+}
+
+int variable_slot(const std::string& key)
+{
+	static const std::map<std::string, int> slots = generate_slots();
+	std::map<std::string, int>::const_iterator it = slots.find(key);
+	return it != slots.end()? it->second: -1;
+}
+
+const std::string& slot_name(int slot)
+{
+	static std::vector<std::string> names(slot_names, slot_names + slot_count);
+	return names[slot];
+}
+
 map_formula_callable::map_formula_callable(
     	const formula_callable* fallback) :
 	formula_callable(false),
 	values_(),
+	slot_mask_(0),
 	fallback_(fallback)
 {}
 
 map_formula_callable& map_formula_callable::add(const std::string& key,
                                                 const variant& value)
 {
+	const int slot = variable_slot(key);
+	if (slot != -1) {
+		return add(slot, value);
+	}
 	values_[key] = value;
 	return *this;
 }
 
+void map_formula_callable::clear()
+{
+	values_.clear();
+	for (int n = 0; n < slot_count; n ++) {
+		slots_[n] = variant();
+	}
+	slot_mask_ = 0;
+}
+
 variant map_formula_callable::get_value(const std::string& key) const
 {
+	const int slot = variable_slot(key);
+	if (slot != -1) {
+		return get_slot_value(slot, key);
+	}
 	return map_get_value_default(values_, key,
 	        fallback_ ? fallback_->query_value(key) : variant());
 }
 
+variant map_formula_callable::get_slot_value(int slot, const std::string& key) const
+{
+	if (slot_mask_ & (1 << slot)) {
+		return slots_[slot];
+	}
+	return fallback_ ? fallback_->query_slot(slot, key) : variant();
+}
+
 void map_formula_callable::get_inputs(std::vector<formula_input>* inputs) const
 {
 	if(fallback_) {
 		fallback_->get_inputs(inputs);
 	}
+	for (int n = 0; n < slot_count; n ++) {
+		if (slot_mask_ & (1 << n)) {
+			inputs->push_back(formula_input(slot_name(n), FORMULA_READ_WRITE));
+		}
+	}
 	for(std::map<std::string,variant>::const_iterator i = values_.begin(); i != values_.end(); ++i) {
 		inputs->push_back(formula_input(i->first, FORMULA_READ_WRITE));
 	}
@@ -64,7 +124,7 @@ void map_formula_callable::get_inputs(std::vector<formula_input>* inputs) const
 
 void map_formula_callable::set_value(const std::string& key, const variant& value)
 {
-	values_[key] = value;
+	add(key, value);
 }
 
 namespace {
@@ -489,7 +549,9 @@ private:
 
 class identifier_expression : public formula_expression {
 public:
-	explicit identifier_expression(const std::string& id) : id_(id)
+	explicit identifier_expression(const std::string& id)
+		: id_(id)
+		, slot_(variable_slot(id))
 	{}
 	std::string str() const
 	{
@@ -497,9 +559,14 @@ public:
 	}
 private:
 	variant execute(const formula_callable& variables, formula_debugger * /*fdb*/) const {
+		if (slot_ != -1) {
+			return variables.query_slot(slot_, id_);
+		}
 		return variables.query_value(id_);
 	}
 	std::string id_;
+	// resolved when parsing, -1 if id_ hasn't slot.
+	int slot_;
 };
 
 class null_expression : public formula_expression {
@@ -508,6 +575,7 @@ public:
 	std::string str() const {
 		return "";
 	}
+	bool is_constant() const { return true; }
 private:
 	variant execute(const formula_callable& /*variables*/, formula_debugger * /*fdb*/) const {
 		return variant();
@@ -525,6 +593,7 @@ public:
 		s << i_;
 		return s.str();
 	}
+	bool is_constant() const { return true; }
 private:
 	variant execute(const formula_callable& /*variables*/, formula_debugger * /*fdb*/) const {
 		return variant(i_);
@@ -544,6 +613,7 @@ public:
 		s << i_ << '.' << f_;
 		return s.str();
 	}
+	bool is_constant() const { return true; }
 private:
 	variant execute(const formula_callable& /*variables*/, formula_debugger * /*fdb*/) const {
 		return variant(i_ * 1000 + f_, variant::DECIMAL_VARIANT );
@@ -584,6 +654,7 @@ public:
 	{
 		return str_.as_string();
 	}
+	bool is_constant() const { return subs_.empty(); }
 private:
 	variant execute(const formula_callable& variables, formula_debugger *fdb) const {
 		if(subs_.empty()) {
@@ -616,6 +687,36 @@ private:
 	std::vector<substitution> subs_;
 };
 
+// result of constant sub-expression, evaluated once when parsing.
+class constant_expression : public formula_expression {
+public:
+	constant_expression(const variant& value, const std::string& str)
+		: value_(value)
+		, str_(str)
+	{}
+
+	std::string str() const { return str_; }
+	bool is_constant() const { return true; }
+private:
+	variant execute(const formula_callable& /*variables*/, formula_debugger * /*fdb*/) const {
+		return value_;
+	}
+
+	variant value_;
+	std::string str_;
+};
+
+static expression_ptr fold_constant(const expression_ptr& expr)
+{
+	static map_formula_callable null_callable;
+	try {
+		return expression_ptr(new constant_expression(expr->evaluate(null_callable), expr->str()));
+	} catch (type_error&) {
+		// for example divide by zero, let it throw when executing.
+		return expr;
+	}
+}
+
 using namespace formula_tokenizer;
 int operator_precedence(const token& t)
 {
@@ -970,9 +1071,11 @@ expression_ptr parse_expression(const token* i1, const token* i2, function_symbo
 	}
 	if(op == i1) {
 		try{
-			return expression_ptr(new unary_operator_expression(
-		                         std::string(op->begin,op->end),
-								 parse_expression(op+1,i2,symbols)));
+			expression_ptr operand = parse_expression(op+1,i2,symbols);
+			const bool constant = operand->is_constant();
+			expression_ptr expr(new unary_operator_expression(
+		                         std::string(op->begin,op->end), operand));
+			return constant? fold_constant(expr): expr;
 		}
 		catch(formula_error& e)	{
 			throw formula_error( e.type, tokens_to_string(begin,end-1), *op->filename, op->line_number);
@@ -994,9 +1097,12 @@ expression_ptr parse_expression(const token* i1, const token* i2, function_symbo
 							   table));
 	}
 
-	return expression_ptr(new operator_expression(
-							     op_name, parse_expression(i1,op,symbols),
-								 parse_expression(op+1,i2,symbols)));
+	expression_ptr left = parse_expression(i1,op,symbols);
+	expression_ptr right = parse_expression(op+1,i2,symbols);
+	// dice is random, must not fold.
+	const bool constant = op_name != "d" && left->is_constant() && right->is_constant();
+	expression_ptr expr(new operator_expression(op_name, left, right));
+	return constant? fold_constant(expr): expr;
 }
 
 }
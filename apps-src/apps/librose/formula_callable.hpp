@@ -22,6 +22,16 @@ namespace game_logic
 {
 
 enum FORMULA_ACCESS_TYPE { FORMULA_READ_ONLY, FORMULA_WRITE_ONLY, FORMULA_READ_WRITE };
+
+// variables used by nearly every gui formula have fixed slot. identifier in formula
+// is resolved to slot when parsing, and map_formula_callable stores them in array.
+enum {slot_screen_width, slot_screen_height, slot_svga, slot_vga, slot_mobile,
+	slot_width, slot_height, slot_dwidth, slot_dheight, slot_extra_width, slot_extra_height,
+	slot_text, slot_count};
+
+// return slot of this variable, -1 if it hasn't slot.
+int variable_slot(const std::string& key);
+const std::string& slot_name(int slot);
 struct formula_input {
 	std::string name;
 	FORMULA_ACCESS_TYPE access;
@@ -43,6 +53,11 @@ public:
 		return get_value(key);
 	}
 
+	// key must be slot_name(slot).
+	variant query_slot(int slot, const std::string& key) const {
+		return get_slot_value(slot, key);
+	}
+
 	void mutate_value(const std::string& key, const variant& value) {
 		set_value(key, value);
 	}
@@ -99,6 +114,7 @@ protected:
         TYPE type_;
 private:
 	virtual variant get_value(const std::string& key) const = 0;
+	virtual variant get_slot_value(int /*slot*/, const std::string& key) const { return query_value(key); }
 	bool has_self_;
 };
 
@@ -156,20 +172,33 @@ class map_formula_callable : public formula_callable {
 public:
 	explicit map_formula_callable(const formula_callable* fallback=NULL);
 	map_formula_callable& add(const std::string& key, const variant& value);
+	map_formula_callable& add(int slot, const variant& value)
+	{
+		slots_[slot] = value;
+		slot_mask_ |= 1 << slot;
+		return *this;
+	}
 	void set_fallback(const formula_callable* fallback) { fallback_ = fallback; }
-	bool empty() const { return values_.empty(); }
-	void clear() { values_.clear(); }
+	bool empty() const { return values_.empty() && !slot_mask_; }
+	void clear();
 
+	// variables without slot. use has_slot/slot_value for slot variables.
 	typedef std::map<std::string,variant>::const_iterator const_iterator;
 
 	const_iterator begin() const { return values_.begin(); }
 	const_iterator end() const { return values_.end(); }
 
+	bool has_slot(int slot) const { return (slot_mask_ & (1 << slot)) != 0; }
+	const variant& slot_value(int slot) const { return slots_[slot]; }
+
 private:
 	variant get_value(const std::string& key) const;
+	variant get_slot_value(int slot, const std::string& key) const;
 	void get_inputs(std::vector<formula_input>* inputs) const;
 	void set_value(const std::string& key, const variant& value);
 	std::map<std::string,variant> values_;
+	variant slots_[slot_count];
+	uint32_t slot_mask_;
 	const formula_callable* fallback_;
 };
 
@@ -37,6 +37,9 @@ public:
 
 	const char* get_name() const { return name_; }
 	virtual std::string str() const = 0;
+
+	// result doesn't depend on variables and is same every time, parser can fold it.
+	virtual bool is_constant() const { return false; }
 private:
 	virtual variant execute(const formula_callable& variables, formula_debugger *fdb = NULL) const = 0;
 	const char* name_;
@@ -70,6 +70,46 @@ public:
 	}
 };
 
+// render-result cache. list is in lru order, front is the most recently used.
+struct tcanvas_cache_item
+{
+	tcanvas::tcache_key key;
+	// hold shapes so that address in key isn't reused by other list.
+	tcanvas::tshape_list_ptr shapes;
+	texture tex;
+	int bytes;
+};
+static std::list<tcanvas_cache_item> canvas_cache_lru;
+static std::map<tcanvas::tcache_key, std::list<tcanvas_cache_item>::iterator> canvas_cache;
+// keys seen once, a key is cached at second sighting.
+static std::set<tcanvas::tcache_key> canvas_cache_seen;
+static const size_t canvas_cache_max_seen = 4096;
+static tcanvas::tcache_stats canvas_cache_stats;
+static const int canvas_cache_budget = 8 * 1024 * 1024; // bytes
+
+bool tcanvas::tcache_key::operator<(const tcache_key& that) const
+{
+	if (shapes != that.shapes) {
+		return shapes < that.shapes;
+	}
+	if (w != that.w) {
+		return w < that.w;
+	}
+	if (h != that.h) {
+		return h < that.h;
+	}
+	return hash < that.hash;
+}
+
+// FNV-1a
+static void cache_key_hash(uint64_t& hash, const void* data, size_t size)
+{
+	const uint8_t* ptr = (const uint8_t*)data;
+	for (size_t at = 0; at < size; at ++) {
+		hash = (hash ^ ptr[at]) * 1099511628211ull;
+	}
+}
+
 namespace {
 
 /*WIKI
@@ -130,7 +170,7 @@ public:
 	explicit tline(const config& cfg);
 
 	/** Implement shape::draw(). */
-	void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none);
+	void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) const;
 
 private:
 	tformula<unsigned>
@@ -425,7 +465,7 @@ tline::tline(const config& cfg)
 	decode_hdpi_off(cfg["hdpi_off"].str(), hdpi_count, hdpi_off_);
 }
 
-void tline::draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none)
+void tline::draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) const
 {
 	uint32_t argb = color_;
 	if (color_ == FORMULA_COLOR) {
@@ -485,7 +525,7 @@ public:
 	explicit trectangle(const config& cfg);
 
 	/** Implement shape::draw(). */
-	void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none);
+	void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) const;
 
 private:
 	tformula<unsigned>
@@ -540,7 +580,7 @@ trectangle::trectangle(const config& cfg)
 	border_thickness_ *= (hdpi_off_[hdpi_thickness]? 1: twidget::hdpi_scale);
 }
 
-void trectangle::draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none)
+void trectangle::draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) const
 {
 	uint32_t border_color_argb = 0;
 	if (border_thickness_) {
@@ -636,7 +676,7 @@ public:
 	explicit tcircle(const config& cfg);
 
 	/** Implement shape::draw(). */
-	void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none);
+	void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) const;
 
 private:
 	tformula<unsigned>
@@ -684,7 +724,7 @@ tcircle::tcircle(const config& cfg)
  */
 }
 
-void tcircle::draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none)
+void tcircle::draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) const
 {
 	/**
 	 * @todo formulas are now recalculated every draw cycle which is a bit
@@ -742,7 +782,7 @@ public:
 	explicit timage(const config& cfg);
 
 	/** Implement shape::draw(). */
-	void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none);
+	void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) const;
 
 private:
 	tformula<unsigned>
@@ -751,11 +791,6 @@ private:
 		w_, /**< The width of the image. */
 		h_; /**< The height of the image. */
 
-	/** The image is cached in this surface. */
-	surface image_;
-
-
-
 	/**
 	 * Name of the image.
 	 *
@@ -795,7 +830,6 @@ timage::timage(const config& cfg)
 	, y_(cfg["y"])
 	, w_(cfg["w"])
 	, h_(cfg["h"])
-	, image_()
 	, image_name_(cfg["name"])
 	, resize_mode_(get_resize_mode(cfg["resize_mode"]))
 	, vertical_mirror_(cfg["vertical_mirror"])
@@ -856,7 +890,7 @@ timage::timage(const config& cfg)
 	decode_hdpi_off(cfg["hdpi_off"].str(), hdpi_count, hdpi_off_);
 }
 
-void timage::draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none)
+void timage::draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) const
 {
 	/**
 	 * @todo formulas are now recalculated every draw cycle which is a  bit
@@ -872,23 +906,20 @@ void timage::draw(texture& canvas, const int canvas_width, const int canvas_heig
 	 * The locator might return a different surface for every call so we can't
 	 * cache the output, also not if no formula is used.
 	 */
-	{
-		surface tmp;
-		if (twidget::hdpi_scale > 1) {
-			tmp = image::get_image(image::locator(get_hdpi_name(name, twidget::hdpi_scale)));
-		}
-		if (!tmp) {
-			tmp = image::get_image(image::locator(name));
-		}
-		if (!tmp) {
-			return;
-		}
-		image_ = tmp;
+	surface img;
+	if (twidget::hdpi_scale > 1) {
+		img = image::get_image(image::locator(get_hdpi_name(name, twidget::hdpi_scale)));
+	}
+	if (!img) {
+		img = image::get_image(image::locator(name));
+	}
+	if (!img) {
+		return;
 	}
 
 	game_logic::map_formula_callable local_variables(variables);
-	local_variables.add("image_original_width", variant(image_->w));
-	local_variables.add("image_original_height", variant(image_->h));
+	local_variables.add("image_original_width", variant(img->w));
+	local_variables.add("image_original_height", variant(img->h));
 
 	unsigned w = w_(local_variables);
 	VALIDATE_WITH_DEV_MESSAGE(
@@ -924,7 +955,7 @@ void timage::draw(texture& canvas, const int canvas_width, const int canvas_heig
 
 
 	// Copy the data to local variables to avoid overwriting the originals.
-	SDL_Rect src_clip = ::create_rect(0, 0, image_->w, image_->h);
+	SDL_Rect src_clip = ::create_rect(0, 0, img->w, img->h);
 	SDL_Rect dst_clip = ::create_rect(x, y, 0, 0);
 	surface surf;
 
@@ -938,47 +969,47 @@ void timage::draw(texture& canvas, const int canvas_width, const int canvas_heig
 
 		if (!w) {
 			if (stretch_image) {
-				// Image: vertical stretch from image_->w, image_->h to a height of h.
+				// Image: vertical stretch from img->w, img->h to a height of h.
 				// when strech vertical, app should set hdpi_off_[hdpi_w] to true. but now don't alert.
-				surf = stretch_surface_vertical(image_, h, canvas_width / twidget::hdpi_scale);
+				surf = stretch_surface_vertical(img, h, canvas_width / twidget::hdpi_scale);
 				done = true;
 			}
-			w = image_->w * (hdpi_off_[hdpi_w]? 1: twidget::hdpi_scale);
+			w = img->w * (hdpi_off_[hdpi_w]? 1: twidget::hdpi_scale);
 		}
 
 		if (!h) {
 			// if h = 0, think use image_original_height. don't conside hdpi_scale.
 			if (stretch_image) {
-				// Image: horizontal stretch from image_->w, image_->h to a width of w.
+				// Image: horizontal stretch from img->w, img->h to a width of w.
 				// when strech horizontal, app should set hdpi_off_[hdpi_h] to true. but now don't alert.
-				surf = stretch_surface_horizontal(image_, w, canvas_height / twidget::hdpi_scale);
+				surf = stretch_surface_horizontal(img, w, canvas_height / twidget::hdpi_scale);
 				done = true;
 			}
-			h = image_->h * (hdpi_off_[hdpi_h]? 1: twidget::hdpi_scale);
+			h = img->h * (hdpi_off_[hdpi_h]? 1: twidget::hdpi_scale);
 		}
 
 		if (!done) {
 			if (resize_mode_ == tile) {
-				// Image: tiling from image_->w, image_->h to w, h.
-				const int columns = (w + image_->w - 1) / image_->w;
-				const int rows = (h + image_->h - 1) / image_->h;
+				// Image: tiling from img->w, img->h to w, h.
+				const int columns = (w + img->w - 1) / img->w;
+				const int rows = (h + img->h - 1) / img->h;
 				surf = create_neutral_surface(w, h);
 
 				for (int x = 0; x < columns; ++x) {
 					for (int y = 0; y < rows; ++y) {
 						SDL_Rect dest = ::create_rect(
-								  x * image_->w
-								, y * image_->h
+								  x * img->w
+								, y * img->h
 								, 0
 								, 0);
-						sdl_blit(image_, NULL, surf, &dest);
+						sdl_blit(img, NULL, surf, &dest);
 					}
 				}
 				src_clip.w = w;
 				src_clip.h = h;
 
 			} else {
-				surf = image_;
+				surf = img;
 			}
 		} else {
 			src_clip.w = w;
@@ -986,14 +1017,14 @@ void timage::draw(texture& canvas, const int canvas_width, const int canvas_heig
 		}
 
 	} else {
-		w = image_->w;
-		h = image_->h;
+		w = img->w;
+		h = img->h;
 
 		if (!hdpi_off_[hdpi_w] || !hdpi_off_[hdpi_h]) {
 			w *= hdpi_off_[hdpi_w]? 1: twidget::hdpi_scale;
 			h *= hdpi_off_[hdpi_h]? 1: twidget::hdpi_scale;
 		}
-		surf = image_;
+		surf = img;
 	}
 
 	dst_clip.w = w;
@@ -1046,13 +1077,7 @@ public:
 	explicit ttext(const config& cfg);
 
 	/** Implement shape::draw(). */
-	void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none);
-
-	void set_default_fields(int font_size, int color_tpl) 
-	{ 
-		default_font_size_ = font_size; 
-		default_color_tpl_ = color_tpl;
-	}
+	void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) const;
 
 private:
 	tformula<unsigned>
@@ -1081,10 +1106,6 @@ private:
 	/** The maximum width for the text. */
 	tformula<int> maximum_width_;
 
-	// from tcontrol
-	int default_font_size_;
-	int default_color_tpl_;
-
 	enum {hdpi_x, hdpi_y, hdpi_count};
 	bool hdpi_off_[hdpi_count];
 };
@@ -1101,8 +1122,6 @@ ttext::ttext(const config& cfg)
 	, text_(cfg["text"])
 	, editable_(cfg["editable"], false)
 	, maximum_width_(cfg["maximum_width"], -1)
-	, default_font_size_(0)
-	, default_color_tpl_(0)
 {
 	type = tcanvas::text_shape;
 
@@ -1148,9 +1167,10 @@ ttext::ttext(const config& cfg)
 	decode_hdpi_off(cfg["hdpi_off"].str(), hdpi_count, hdpi_off_);
 }
 
-void ttext::draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none)
+void ttext::draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) const
 {
-	int font_size = default_font_size_;
+	// shape is shared by all canvas of this state, default fields come from drawing widget.
+	int font_size = canvas_widget->get_text_font_size();
 	if (font_size_) {
 		if (font_size_ < font_min_relative_size) {
 			font_size = font_size_;
@@ -1166,7 +1186,7 @@ void ttext::draw(texture& canvas, const int canvas_width, const int canvas_heigh
 		tformula<unsigned> f(color_str_);
 		argb = f(variables);
 	} else if (color_ >= PREDEFINE_COLOR && color_ < PREDEFINE_COLOR + theme::tpl_colors) {
-		argb = theme::text_color_from_index(default_color_tpl_, color_ - PREDEFINE_COLOR);
+		argb = theme::text_color_from_index(canvas_widget->get_text_color_tpl(), color_ - PREDEFINE_COLOR);
 	}
 
 	VALIDATE(variables.has_key("text"), null_str);
@@ -1262,10 +1282,10 @@ public:
 	explicit tblit(const config& cfg);
 
 	/** Implement shape::draw(). */
-	void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none);
+	void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) const;
 
 private:
-	void post_handle(texture& canvas, const int canvas_width, const int canvas_height);
+	void post_handle(texture& canvas, const int canvas_width, const int canvas_height) const;
 
 private:
 	tformula<unsigned>
@@ -1289,7 +1309,7 @@ tblit::tblit(const config& cfg)
 	decode_hdpi_off(cfg["hdpi_off"].str(), hdpi_count, hdpi_off_);
 }
 
-void tblit::draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none)
+void tblit::draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) const
 {
 	unsigned w = w_(variables);
 	VALIDATE_WITH_DEV_MESSAGE(
@@ -1345,7 +1365,7 @@ void tblit::draw(texture& canvas, const int canvas_width, const int canvas_heigh
 	post_handle(canvas, canvas_width, canvas_height);
 }
 
-void tblit::post_handle(texture& canvas, const int canvas_width, const int canvas_height)
+void tblit::post_handle(texture& canvas, const int canvas_width, const int canvas_height) const
 {
 	// ~CS()~CS(50,50,50)
 	const std::vector<std::string> modlist = utils::parenthetical_split(post_, '~');
@@ -1409,18 +1429,16 @@ public:
 	explicit tanim(const config& cfg, size_t position);
 
 	/** Implement shape::draw(). */
-	void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none);
+	void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) const;
 
 public:
 	size_t position_;
 	config cfg_;
-	int id_;
 };
 
 tanim::tanim(const config& cfg, size_t position)
 	: position_(position)
 	, cfg_(cfg)
-	, id_(INVALID_ANIM_ID)
 {
 	type = tcanvas::anim_shape;
 /*WIKI
@@ -1463,9 +1481,10 @@ tanim::tanim(const config& cfg, size_t position)
  */
 }
 
-void tanim::draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none)
+void tanim::draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) const
 {
-	draw_canvas_anim(*display::get_singleton(), id_, canvas, ::create_rect(0, 0, canvas_width, canvas_height), true);
+	// animation id is per canvas, tcanvas::draw draws it.
+	VALIDATE(false, null_str);
 }
 
 } // namespace
@@ -1552,12 +1571,12 @@ void tcanvas::draw(const tcontrol& widget, const SDL_Rect& canvas_clip_rect, boo
 
 	if (dirty_) {
 		get_screen_size_variables(variables_);
-		variables_.add("width", variant(w_ / twidget::hdpi_scale));
-		variables_.add("height", variant(h_ / twidget::hdpi_scale));
-		variables_.add("dwidth", variant(w_));
-		variables_.add("dheight", variant(h_));
-		variables_.add("extra_width", variant(widget.config()->text_extra_width / twidget::hdpi_scale));
-		variables_.add("extra_height", variant(widget.config()->text_extra_height / twidget::hdpi_scale));
+		variables_.add(game_logic::slot_width, variant(w_ / twidget::hdpi_scale));
+		variables_.add(game_logic::slot_height, variant(h_ / twidget::hdpi_scale));
+		variables_.add(game_logic::slot_dwidth, variant(w_));
+		variables_.add(game_logic::slot_dheight, variant(h_));
+		variables_.add(game_logic::slot_extra_width, variant(widget.config()->text_extra_width / twidget::hdpi_scale));
+		variables_.add(game_logic::slot_extra_height, variant(widget.config()->text_extra_height / twidget::hdpi_scale));
 	}
 
 	SDL_Renderer* renderer = get_renderer();
@@ -1567,6 +1586,30 @@ void tcanvas::draw(const tcontrol& widget, const SDL_Rect& canvas_clip_rect, boo
 	texture_clip_rect_setter clip(NULL);
 
 	if (dirty_ || force || !animated || mixed_) {
+		tcache_key cache_key;
+		const int bytes = w_ * h_ * 4;
+		bool cacheable = !animated && !mixed_ && !share_canvas_integrate && bytes <= canvas_cache_budget / 8 && generate_cache_key(widget, cache_key);
+		if (cacheable) {
+			std::map<tcache_key, std::list<tcanvas_cache_item>::iterator>::iterator find_it = canvas_cache.find(cache_key);
+			if (find_it != canvas_cache.end()) {
+				canvas_cache_stats.hits ++;
+				canvas_cache_lru.splice(canvas_cache_lru.begin(), canvas_cache_lru, find_it->second);
+				// widget maybe draw on it's canvas_(for example ttrack), don't share cached texture.
+				canvas_ = clone_texture(find_it->second->tex);
+				dirty_ = false;
+				return;
+			}
+			canvas_cache_stats.misses ++;
+			// first sighting only remember it, avoid clone texture of unique content.
+			if (canvas_cache_seen.erase(cache_key) == 0) {
+				if (canvas_cache_seen.size() >= canvas_cache_max_seen) {
+					canvas_cache_seen.clear();
+				}
+				canvas_cache_seen.insert(cache_key);
+				cacheable = false;
+			}
+		}
+
 		// create surface
 		canvas_ = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w_, h_);
 		SDL_SetTextureBlendMode(canvas_.get(), SDL_BLENDMODE_BLEND);
@@ -1582,20 +1625,17 @@ void tcanvas::draw(const tcontrol& widget, const SDL_Rect& canvas_clip_rect, boo
 
 		// draw items
 		bool blend_none = true;
-		for (std::vector<tshape_ptr>::iterator itor = shapes_.begin(); itor != shapes_.end(); ++ itor) {
-			tshape& shape = **itor;
-			if (shape.type == text_shape) {
-				// this is text shape
-				ttext* text = dynamic_cast<ttext*>(&shape);
-				text->set_default_fields(widget.get_text_font_size(), widget.get_text_color_tpl());
-
-			} else if (shape.type == anim_shape) {
+		const std::vector<tshape_ptr>& shapes = this->shapes();
+		for (std::vector<tshape_ptr>::const_iterator itor = shapes.begin(); itor != shapes.end(); ++ itor) {
+			const tshape& shape = **itor;
+			if (shape.type == anim_shape) {
 				// this is animation shape
-				tanim* anim = dynamic_cast<tanim*>(&shape);
-				anim->id_ = anims_.find(anim->position_)->second;
-			} 
+				const tanim* anim = dynamic_cast<const tanim*>(&shape);
+				draw_canvas_anim(disp, anims_.find(anim->position_)->second, canvas_, ::create_rect(0, 0, w_, h_), true);
 
-			shape.draw(canvas_, w_, h_, variables_, blend_none);
+			} else {
+				shape.draw(canvas_, w_, h_, variables_, blend_none);
+			}
 			blend_none = false;
 		}
 
@@ -1607,6 +1647,26 @@ void tcanvas::draw(const tcontrol& widget, const SDL_Rect& canvas_clip_rect, boo
 			draw_canvas_anim(disp, *itor, canvas_, ::create_rect(0, 0, w_, h_), true);
 		}
 
+		if (cacheable) {
+			while (!canvas_cache_lru.empty() && canvas_cache_stats.bytes + bytes > canvas_cache_budget) {
+				const tcanvas_cache_item& oldest = canvas_cache_lru.back();
+				canvas_cache_stats.bytes -= oldest.bytes;
+				canvas_cache_stats.evictions ++;
+				canvas_cache.erase(oldest.key);
+				canvas_cache_lru.pop_back();
+			}
+
+			canvas_cache_lru.push_front(tcanvas_cache_item());
+			tcanvas_cache_item& item = canvas_cache_lru.front();
+			item.key = cache_key;
+			item.shapes = shapes_;
+			item.tex = clone_texture(canvas_);
+			item.bytes = bytes;
+			canvas_cache[cache_key] = canvas_cache_lru.begin();
+			canvas_cache_stats.bytes += bytes;
+			canvas_cache_stats.items = canvas_cache.size();
+		}
+
 	} else {
 		trender_target_lock lock(renderer, canvas_);
 
@@ -1620,26 +1680,24 @@ void tcanvas::draw(const tcontrol& widget, const SDL_Rect& canvas_clip_rect, boo
 			share_canvas_integrate->animated_undraw(disp, canvas_, canvas_clip_rect);
 		}
 
-		for (std::vector<tshape_ptr>::reverse_iterator ritor = shapes_.rbegin(); ritor != shapes_.rend(); ++ ritor) {
+		const std::vector<tshape_ptr>& shapes = this->shapes();
+		for (std::vector<tshape_ptr>::const_reverse_iterator ritor = shapes.rbegin(); ritor != shapes.rend(); ++ ritor) {
 			if ((*ritor)->type != anim_shape) {
 				break;
 			}
 			// this is animation shape
-			int id = anims_.find(dynamic_cast<tanim*>(&**ritor)->position_)->second;
+			int id = anims_.find(dynamic_cast<const tanim*>(&**ritor)->position_)->second;
 			float_animation& anim = *dynamic_cast<float_animation*>(&disp.area_anim(id));
 			anim.undraw(canvas_);
 		}
 
-		for (std::vector<tshape_ptr>::iterator itor = shapes_.begin(); itor != shapes_.end(); ++itor) {
-			if ((*itor)->type == anim_shape) {
-				// this is animation shape
-				tanim* anim = dynamic_cast<tanim*>(&**itor);
-				anim->id_ = anims_.find(anim->position_)->second;
-			} else {
+		for (std::vector<tshape_ptr>::const_iterator itor = shapes.begin(); itor != shapes.end(); ++itor) {
+			if ((*itor)->type != anim_shape) {
 				continue;
 			}
-
-			(*itor)->draw(canvas_, w_, h_, variables_, false);
+			// this is animation shape
+			const tanim* anim = dynamic_cast<const tanim*>(&**itor);
+			draw_canvas_anim(disp, anims_.find(anim->position_)->second, canvas_, ::create_rect(0, 0, w_, h_), true);
 		}
 
 		if (share_canvas_integrate) {
@@ -1656,7 +1714,7 @@ void tcanvas::draw(const tcontrol& widget, const SDL_Rect& canvas_clip_rect, boo
 
 void tcanvas::blit(const tcontrol& widget, texture& surf, SDL_Rect rect, bool force, const std::vector<int>& post_anims)
 {
-	if (shapes_.empty()) {
+	if (shapes().empty()) {
 		return;
 	}
 
@@ -1742,10 +1800,102 @@ void tcanvas::parse_cfg(const config& cfg, std::vector<tshape_ptr>& shapes, unsi
 	}
 }
 
+void tcanvas::set_cfg(const config& cfg)
+{
+	tshape_list* list = new tshape_list;
+	shapes_ = list;
+	parse_cfg(cfg, list->shapes, &blur_depth_);
+
+	for (std::vector<tshape_ptr>::const_iterator it = list->shapes.begin(); it != list->shapes.end(); ++ it) {
+		// blit's images come from widget, anim changes every frame.
+		if ((*it)->type == blit_shape || (*it)->type == anim_shape) {
+			list->cacheable = false;
+			break;
+		}
+	}
+}
+
+bool tcanvas::generate_cache_key(const tcontrol& widget, tcache_key& key) const
+{
+	if (!shapes_ || !shapes_->cacheable || !w_ || !h_) {
+		return false;
+	}
+
+	key.shapes = shapes_.get();
+	key.w = w_;
+	key.h = h_;
+	uint64_t hash = 14695981039346656037ull;
+	const int font_size = widget.get_text_font_size();
+	const int color_tpl = widget.get_text_color_tpl();
+	cache_key_hash(hash, &font_size, sizeof(font_size));
+	cache_key_hash(hash, &color_tpl, sizeof(color_tpl));
+	std::vector<std::pair<const std::string*, const variant*> > values;
+	for (int slot = 0; slot < game_logic::slot_count; slot ++) {
+		if (variables_.has_slot(slot)) {
+			values.push_back(std::make_pair(&game_logic::slot_name(slot), &variables_.slot_value(slot)));
+		}
+	}
+	for (game_logic::map_formula_callable::const_iterator it = variables_.begin(); it != variables_.end(); ++ it) {
+		values.push_back(std::make_pair(&it->first, &it->second));
+	}
+	for (std::vector<std::pair<const std::string*, const variant*> >::const_iterator it = values.begin(); it != values.end(); ++ it) {
+		const variant& value = *it->second;
+		const std::string& name = *it->first;
+		// size prefix and type tag keep adjacent fields from aliasing.
+		int size = name.size();
+		cache_key_hash(hash, &size, sizeof(size));
+		cache_key_hash(hash, name.c_str(), size);
+		if (value.is_string()) {
+			const std::string& str = value.as_string();
+			size = str.size();
+			cache_key_hash(hash, "s", 1);
+			cache_key_hash(hash, &size, sizeof(size));
+			cache_key_hash(hash, str.c_str(), size);
+		} else if (value.is_int()) {
+			const int val = value.as_int();
+			cache_key_hash(hash, "i", 1);
+			cache_key_hash(hash, &val, sizeof(val));
+		} else if (value.is_decimal()) {
+			const int val = value.as_decimal();
+			cache_key_hash(hash, "d", 1);
+			cache_key_hash(hash, &val, sizeof(val));
+		} else if (!value.is_null()) {
+			// callable, list or map, can not compare it by value.
+			return false;
+		} else {
+			cache_key_hash(hash, "n", 1);
+		}
+	}
+	key.hash = hash;
+	return true;
+}
+
+const tcanvas::tcache_stats& tcanvas::cache_stats()
+{
+	canvas_cache_stats.items = canvas_cache.size();
+	return canvas_cache_stats;
+}
+
+void tcanvas::flush_cache()
+{
+	canvas_cache.clear();
+	canvas_cache_lru.clear();
+	canvas_cache_seen.clear();
+	canvas_cache_stats.items = 0;
+	canvas_cache_stats.bytes = 0;
+}
+
+const std::vector<tcanvas::tshape_ptr>& tcanvas::shapes() const
+{
+	static const std::vector<tshape_ptr> empty_shapes;
+	return shapes_? shapes_->shapes: empty_shapes;
+}
+
 bool tcanvas::start_animation()
 {
 	display& disp = *display::get_singleton();
-	for (std::vector<tshape_ptr>::iterator it = shapes_.begin(); it != shapes_.end(); ++ it) {
+	const std::vector<tshape_ptr>& shapes = this->shapes();
+	for (std::vector<tshape_ptr>::const_iterator it = shapes.begin(); it != shapes.end(); ++ it) {
 		if ((*it)->type != anim_shape) {
 			if (!mixed_ && !anims_.empty()) {
 				mixed_ = true;
@@ -1753,7 +1903,7 @@ bool tcanvas::start_animation()
 			continue;
 		}
 		// this is animation shape
-		tanim* anim = dynamic_cast<tanim*>(&**it);
+		const tanim* anim = dynamic_cast<const tanim*>(&**it);
 		int id = start_cycle_float_anim(disp, anim->cfg_);
 		if (id == INVALID_ANIM_ID) {
 			continue;
@@ -71,7 +71,7 @@ public:
 		 *                        definition, this parameter contains the values
 		 *                        for these formulas.
 		 */
-		virtual void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) = 0;
+		virtual void draw(texture& canvas, const int canvas_width, const int canvas_height, const game_logic::map_formula_callable& variables, bool blend_none) const = 0;
 
 		int type;
 	};
@@ -79,6 +79,27 @@ public:
 	typedef boost::intrusive_ptr<tshape> tshape_ptr;
 	typedef boost::intrusive_ptr<const tshape> const_tshape_ptr;
 
+	/**
+	 * Shapes parsed from one [draw].
+	 *
+	 * It is immutable after parse, canvas copied from a state's canvas
+	 * references the same list. Per-instance data is in variables_ and canvas_.
+	 */
+	class tshape_list: public reference_counted_object
+	{
+	public:
+		tshape_list()
+			: shapes()
+			, cacheable(true)
+		{}
+
+		std::vector<tshape_ptr> shapes;
+
+		// result depends only on variables and size, can use render-result cache.
+		bool cacheable;
+	};
+	typedef boost::intrusive_ptr<const tshape_list> tshape_list_ptr;
+
 	/**
 	 * Parses a config object.
 	 *
@@ -120,7 +141,7 @@ public:
 	 *                            http://www.wesnoth.org/wiki/GUICanvasWML for
 	 *                            more information.
 	 */
-	void set_cfg(const config& cfg) { parse_cfg(cfg, shapes_, &blur_depth_); }
+	void set_cfg(const config& cfg);
 
 	/***** ***** ***** setters / getters for members ***** ****** *****/
 
@@ -139,6 +160,12 @@ public:
 		set_dirty();
 	}
 
+	void set_variable(int slot, const variant& value)
+	{
+		variables_.add(slot, value);
+		set_dirty();
+	}
+
 	const game_logic::map_formula_callable& variables() const { return variables_; }
 
 	bool start_animation();
@@ -147,9 +174,57 @@ public:
 
 	texture get_canvas_tex(tcontrol& widget, const std::vector<int>& post_anims);
 
+	struct tcache_stats
+	{
+		tcache_stats()
+			: hits(0)
+			, misses(0)
+			, evictions(0)
+			, items(0)
+			, bytes(0)
+		{}
+
+		int hits;
+		int misses;
+		int evictions;
+		int items;
+		int bytes;
+	};
+
+	// shapes, size and hash of font/color and variables.
+	struct tcache_key
+	{
+		tcache_key()
+			: shapes(NULL)
+			, w(0)
+			, h(0)
+			, hash(0)
+		{}
+
+		bool operator<(const tcache_key& that) const;
+
+		const tshape_list* shapes;
+		int w;
+		int h;
+		uint64_t hash;
+	};
+
+	/**
+	 * Render results are cached by shapes, size and variables, so revisiting
+	 * the same visual state copies a texture instead of drawing shapes again.
+	 * A key is cached only at its second sighting, rows with unique text don't thrash it.
+	 */
+	static const tcache_stats& cache_stats();
+	static void flush_cache();
+
 private:
-	/** Vector with the shapes to draw. */
-	std::vector<tshape_ptr> shapes_;
+	/** Shapes to draw, shared with canvas of the same definition and state. */
+	tshape_list_ptr shapes_;
+
+	const std::vector<tshape_ptr>& shapes() const;
+
+	/** Key of render-result cache. false if this draw must not be cached. */
+	bool generate_cache_key(const tcontrol& widget, tcache_key& key) const;
 
 	/**
 	 * The depth of the blur to use in the pre committing.
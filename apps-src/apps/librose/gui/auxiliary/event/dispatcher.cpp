@@ -44,19 +44,15 @@ bool tdispatcher::has_event(const tevent event
 		, const tevent_type event_type
 		)
 {
-	return find<tset_event>(event, tdispatcher_implementation
-					::thas_handler(event_type, *this))
-			|| find<tset_event_mouse>(event, tdispatcher_implementation
-					::thas_handler(event_type, *this))
-			|| find<tset_event_keyboard>(event, tdispatcher_implementation
-					::thas_handler(event_type, *this))
-			|| find<tset_event_textinput>(event, tdispatcher_implementation
-					::thas_handler(event_type, *this))
-			|| find<tset_event_notification>(event, tdispatcher_implementation
-					::thas_handler(event_type, *this))
-			|| find<tset_event_message>(event, tdispatcher_implementation
-					::thas_handler(event_type, *this))
-			;
+	// every event is in one set only, test bit of all queues.
+	const uint32_t mask = signal_queue_.mask(event_type)
+			| signal_mouse_queue_.mask(event_type)
+			| signal_keyboard_queue_.mask(event_type)
+			| signal_textinput_queue_.mask(event_type)
+			| signal_notification_queue_.mask(event_type)
+			| signal_message_queue_.mask(event_type);
+
+	return (mask & (1u << event)) != 0;
 }
 
 /**
@@ -22,9 +22,11 @@
 
 #include <boost/function.hpp>
 #include <boost/mpl/int.hpp>
+#include <boost/static_assert.hpp>
 #include <boost/utility/enable_if.hpp>
 
 #include <map>
+#include <memory>
 
 namespace gui2 {
 
@@ -586,47 +588,126 @@ public:
 	struct tsignal_queue
 	{
 		tsignal_queue()
-			: queue()
+			: slots()
+			, allocated(0)
+			, pre_mask(0)
+			, child_mask(0)
+			, post_mask(0)
 		{
 		}
 
-		std::map<tevent, tsignal<T> > queue;
+		/**
+		 * Signals of connected events, sorted by event.
+		 *
+		 * Bit n of allocated is set when event n has a slot, so the slot
+		 * index is the number of allocated bits below it. tsignal is held by
+		 * pointer so it stays valid while a callback connects new events.
+		 */
+		std::vector<std::unique_ptr<tsignal<T> > > slots;
+		uint32_t allocated;
+
+		/** Bit n is set when event n has callbacks in pre_child/child/post_child. */
+		uint32_t pre_mask;
+		uint32_t child_mask;
+		uint32_t post_mask;
+
+		// every event must have a bit in uint32_t.
+		BOOST_STATIC_ASSERT(MESSAGE_SHOW_TOOLTIP < 32);
+
+		static int slot_at(const uint32_t allocated, const tevent event)
+		{
+			uint32_t bits = allocated & ((1u << event) - 1);
+			int count = 0;
+			for (; bits; count ++) {
+				bits &= bits - 1;
+			}
+			return count;
+		}
+
+		/** Returns the signal of event, create it when not exist. */
+		tsignal<T>& signal(const tevent event)
+		{
+			const uint32_t bit = 1u << event;
+			const int at = slot_at(allocated, event);
+			if (!(allocated & bit)) {
+				slots.insert(slots.begin() + at, std::unique_ptr<tsignal<T> >(new tsignal<T>()));
+				allocated |= bit;
+			}
+			return *slots[at];
+		}
+
+		uint32_t mask(const tevent_type event_type) const
+		{
+			uint32_t result = 0;
+			if (event_type & pre) {
+				result |= pre_mask;
+			}
+			if (event_type & child) {
+				result |= child_mask;
+			}
+			if (event_type & post) {
+				result |= post_mask;
+			}
+			return result;
+		}
+
+		void update_mask(const tevent event)
+		{
+			const uint32_t bit = 1u << event;
+			pre_mask &= ~bit;
+			child_mask &= ~bit;
+			post_mask &= ~bit;
+			if (!(allocated & bit)) {
+				return;
+			}
+			const tsignal<T>& s = *slots[slot_at(allocated, event)];
+			if (!s.pre_child.empty()) {
+				pre_mask |= bit;
+			}
+			if (!s.child.empty()) {
+				child_mask |= bit;
+			}
+			if (!s.post_child.empty()) {
+				post_mask |= bit;
+			}
+		}
 
 		void connect_signal(const tevent event
 				, const tposition position
-				, const T& signal)
+				, const T& function)
 		{
+			tsignal<T>& queue = signal(event);
 			switch(position) {
 				case front_pre_child :
-					queue[event].pre_child.insert(
-							queue[event].pre_child.begin(), signal);
+					queue.pre_child.insert(
+							queue.pre_child.begin(), function);
 					break;
 				case back_pre_child :
-					queue[event].pre_child.push_back(signal);
+					queue.pre_child.push_back(function);
 					break;
 
 				case front_child :
-					queue[event].child.insert(
-							queue[event].child.begin(), signal);
+					queue.child.insert(
+							queue.child.begin(), function);
 					break;
 				case back_child :
-					queue[event].child.push_back(signal);
+					queue.child.push_back(function);
 					break;
 
 				case front_post_child :
-					queue[event].post_child.insert(
-							queue[event].post_child.begin(), signal);
+					queue.post_child.insert(
+							queue.post_child.begin(), function);
 					break;
 				case back_post_child :
-					queue[event].post_child.push_back(signal);
+					queue.post_child.push_back(function);
 					break;
 			}
-
+			update_mask(event);
 		}
 
 		void disconnect_signal(const tevent event
 				, const tposition position
-				, const T& signal)
+				, const T& function)
 		{
 			/*
 			 * The function doesn't differentiate between front and back
@@ -635,14 +716,15 @@ public:
 			switch(position) {
 				case front_pre_child :
 				case back_pre_child : {
-						tsignal<T>& signal_queue = queue[event];
+						tsignal<T>& signal_queue = signal(event);
 						for(typename std::vector<T>::iterator itor =
 									signal_queue.child.begin()
 								; itor != signal_queue.child.end()
 								; ++itor) {
 
-							if(signal.target_type() == itor->target_type()) {
+							if(function.target_type() == itor->target_type()) {
 								signal_queue.child.erase(itor);
+								update_mask(event);
 								return;
 							}
 						}
@@ -651,14 +733,15 @@ public:
 
 				case front_child :
 				case back_child : {
-						tsignal<T>& signal_queue = queue[event];
+						tsignal<T>& signal_queue = signal(event);
 						for(typename std::vector<T>::iterator itor =
 									signal_queue.child.begin()
 								; itor != signal_queue.child.end()
 								; ++itor) {
 
-							if(signal.target_type() == itor->target_type()) {
+							if(function.target_type() == itor->target_type()) {
 								signal_queue.child.erase(itor);
+								update_mask(event);
 								return;
 							}
 						}
@@ -667,14 +750,15 @@ public:
 
 				case front_post_child :
 				case back_post_child : {
-						tsignal<T>& signal_queue = queue[event];
+						tsignal<T>& signal_queue = signal(event);
 						for(typename std::vector<T>::iterator itor =
 									signal_queue.child.begin()
 								; itor != signal_queue.child.end()
 								; ++itor) {
 
-							if(signal.target_type() == itor->target_type()) {
+							if(function.target_type() == itor->target_type()) {
 								signal_queue.child.erase(itor);
+								update_mask(event);
 								return;
 							}
 						}
@@ -63,7 +63,7 @@ struct tdispatcher_implementation
 			>::type&                                                          \
 	event_signal(tdispatcher& dispatcher, const tevent event)                 \
 	{                                                                         \
-		return dispatcher.QUEUE.queue[event];                                 \
+		return dispatcher.QUEUE.signal(event);                                \
 	}                                                                         \
                                                                               \
 	/**                                                                       \
@@ -86,7 +86,7 @@ struct tdispatcher_implementation
 			>::type&                                                          \
 	event_signal(tdispatcher& dispatcher, const tevent event)                 \
 	{                                                                         \
-		return dispatcher.QUEUE.queue[event];                                 \
+		return dispatcher.QUEUE.signal(event);                                \
 	}                                                                         \
 
 
@@ -114,61 +114,6 @@ struct tdispatcher_implementation
 
 #undef IMPLEMENT_EVENT_SIGNAL_WRAPPER
 #undef IMPLEMENT_EVENT_SIGNAL
-
-	/**
-	 * A helper class to find out whether dispatcher has an handler for a
-	 * certain event.
-	 */
-	class thas_handler
-	{
-	public:
-		/**
-		 * Constructor.
-		 *
-		 * @param event_type      The type of event to look for.
-		* @param dispatcher      The dispatcher whose signal queue is used.
-		 */
-		thas_handler(const tdispatcher::tevent_type event_type
-				, tdispatcher& dispatcher)
-			: event_type_(event_type)
-			, dispatcher_(dispatcher)
-		{}
-
-		/**
-		 * Tests whether a handler for an event is available.
-		 *
-		 * It tests for both the event and the event_type send in the
-		 * constructor.
-		 *
-		 * @tparam T              A key from an event set used to instanciate
-		 *                        the proper @p event_signal function.
-		* @param event           The event to get the signal for.
-		 *
-		 * @returns               Whether or not the handler is found.
-		 */
-		// not called operator() to work around a problem in MSVC 2008.
-		template<class T>
-		bool oper(tevent event)
-		{
-			if((event_type_ & tdispatcher::pre)
-					&& !event_signal<T>(dispatcher_, event).pre_child.empty()) {
-				return true;
-			}
-			if((event_type_ & tdispatcher::child)
-					&& !event_signal<T>(dispatcher_, event).child.empty()) {
-				return true;
-			}
-			if((event_type_ & tdispatcher::post)
-					&& !event_signal<T>(dispatcher_, event).post_child.empty()){
-				return true;
-			}
-			return false;
-		}
-
-	private:
-		tdispatcher::tevent_type event_type_;
-		tdispatcher& dispatcher_;
-	};
 };
 
 /** Contains the implementation details of the find function. */
@@ -107,6 +107,9 @@ private:
 	 */
 	T execute(const game_logic::map_formula_callable& variables) const;
 
+	/** Returns parsed formula_, it is parsed at first execute and shared by copies. */
+	const game_logic::formula& compiled() const;
+
 	/**
 	 * Contains the formuale for the variable.
 	 *
@@ -114,6 +117,8 @@ private:
 	 */
 	std::string formula_;
 
+	mutable game_logic::const_formula_ptr compiled_;
+
 	/**
 	 * Contains the formuale or value for the variable.
 	 *
@@ -128,6 +133,7 @@ private:
 template<class T>
 tformula<T>::tformula(const std::string& str, const T value)
 	: formula_()
+	, compiled_()
 	, formula2_(false)
 	, value_(value)
 {
@@ -157,39 +163,48 @@ inline T tformula<T>::operator()(
 	}
 }
 
+template<class T>
+inline const game_logic::formula& tformula<T>::compiled() const
+{
+	if (!compiled_) {
+		compiled_.reset(new game_logic::formula(formula_));
+	}
+	return *compiled_;
+}
+
 template<>
 inline bool tformula<bool>::execute(
 		const game_logic::map_formula_callable& variables) const
 {
-	return game_logic::formula(formula_).evaluate(variables).as_bool();
+	return compiled().evaluate(variables).as_bool();
 }
 
 template<>
 inline int tformula<int>::execute(
 		const game_logic::map_formula_callable& variables) const
 {
-	return game_logic::formula(formula_).evaluate(variables).as_int();
+	return compiled().evaluate(variables).as_int();
 }
 
 template<>
 inline unsigned tformula<unsigned>::execute(
 		const game_logic::map_formula_callable& variables) const
 {
-	return game_logic::formula(formula_).evaluate(variables).as_int();
+	return compiled().evaluate(variables).as_int();
 }
 
 template<>
 inline std::string tformula<std::string>::execute(
 		const game_logic::map_formula_callable& variables) const
 {
-	return game_logic::formula(formula_).evaluate(variables).as_string();
+	return compiled().evaluate(variables).as_string();
 }
 
 template<>
 inline t_string tformula<t_string>::execute(
 		const game_logic::map_formula_callable& variables) const
 {
-	return game_logic::formula(formula_).evaluate(variables).as_string();
+	return compiled().evaluate(variables).as_string();
 }
 
 template<class T>
@@ -245,7 +245,9 @@ int tchat_::tsession::logs_per_page = 50;
 
 tchat_::tsession::tsession(chat_logs::treceiver& receiver)
 	: receiver(&receiver)
+	, history_log(tlobby_user::npos, null_str, 0, 0, 0, 0)
 	, current_page(0)
+	, page_start_(0)
 {
 	const chat_logs::thistory_log* choice = NULL;
 	for (std::set<chat_logs::thistory_log>::const_iterator it = chat_logs::history_logs.begin(); it != chat_logs::history_logs.end(); ++ it) {
@@ -258,14 +260,25 @@ tchat_::tsession::tsession(chat_logs::treceiver& receiver)
 	if (!choice) {
 		return;
 	}
-	chat_logs::user_from_logfile(*choice, history);
+	history_log = *choice;
+	chat_logs::offsets_from_logfile(history_log, history);
+}
+
+void tchat_::tsession::read_logs(int start, int end, std::vector<chat_logs::tlog>& logs) const
+{
+	int history_size = history.size();
+	if (start < history_size) {
+		chat_logs::logs_from_logfile(history_log, history, start, posix_min(end, history_size - 1), logs);
+	}
+	if (end >= history_size) {
+		receiver->read_logs(posix_max(start, history_size) - history_size, end - history_size, logs);
+	}
 }
 
 int tchat_::tsession::current_logs(std::vector<chat_logs::tlog>& logs) const
 {
 	logs.clear();
-	int history_size = history.size();
-	int size = history_size + receiver->logs.size();
+	int size = this->size();
 	if (!size) {
 		return twidget::npos;
 	}
@@ -284,44 +297,16 @@ int tchat_::tsession::current_logs(std::vector<chat_logs::tlog>& logs) const
 		}
 	}
 
-	int history_start = -1, history_end = -1, now_start = -1, now_end = -1;
-	if (history_size > start) {
-		history_start = start;
-		if (history_size > end) {
-			history_end = end;
-		} else {
-			history_end = history_size - 1;
-			now_start = 0;
-			now_end = (end - start) - (history_end - history_start + 1);
-		}
-	} else {
-		now_start = start - history_size;
-		now_end = end - history_size;
-	}
-
-	std::vector<chat_logs::tlog>::const_iterator begin_it;
-	std::vector<chat_logs::tlog>::const_iterator end_it;
-	if (history_start != -1) {
-		begin_it = history.begin();
-		std::advance(begin_it, history_start);
-		end_it = history.begin();
-		std::advance(end_it, history_end + 1);
-		std::copy(begin_it, end_it, std::back_inserter(logs));
-	}
-	if (now_start != -1) {
-		begin_it = receiver->logs.begin();
-		std::advance(begin_it, now_start);
-		end_it = receiver->logs.begin();
-		std::advance(end_it, now_end + 1);
-		std::copy(begin_it, end_it, std::back_inserter(logs));
-	}
+	read_logs(start, end, logs);
 
+	page_logs_ = logs;
+	page_start_ = start;
 	return start;
 }
 
 int tchat_::tsession::pages() const
 {
-	return ceil(1.0 * (history.size() + receiver->logs.size()) / logs_per_page);
+	return ceil(1.0 * size() / logs_per_page);
 }
 
 bool tchat_::tsession::can_previous() const 
@@ -338,14 +323,53 @@ bool tchat_::tsession::can_next() const
 
 const chat_logs::tlog& tchat_::tsession::log(int at) const
 {
-	const chat_logs::tlog* log = NULL;
-	int history_size = (int)history.size();
-	if (at < history_size) {
-		log = &history[at];
+	const int memory_start = (int)history.size() + receiver->evicted;
+	if (at >= memory_start) {
+		// in memory, and maybe merged after current_logs.
+		return receiver->logs[at - memory_start];
+	}
+	if (at < page_start_ || at >= page_start_ + (int)page_logs_.size()) {
+		page_logs_.clear();
+		read_logs(at, at, page_logs_);
+		page_start_ = at;
+	}
+	return page_logs_[at - page_start_];
+}
+
+int tchat_::tsession::locate(const chat_logs::tsearch_hit& hit)
+{
+	if (hit.receiver != receiver->nick) {
+		return twidget::npos;
+	}
+
+	int at = twidget::npos;
+	if (!hit.journal) {
+		if (hit.offset < (int)history.size()) {
+			at = hit.offset;
+		}
 	} else {
-		log = &receiver->logs[at - history_size];
+		const std::vector<chat_logs::tlog_index>& indexs = receiver->indexs;
+		for (int n = 0; n < (int)indexs.size(); n ++) {
+			if (indexs[n].offset == hit.offset) {
+				at = history.size() + n;
+				break;
+			}
+		}
+	}
+	if (at == twidget::npos) {
+		return twidget::npos;
+	}
+
+	// reverse of current_logs. first page(oldest) maybe has less than logs_per_page logs.
+	int remainder = size() % logs_per_page;
+	int page;
+	if (remainder) {
+		page = at < remainder? 0: (at - remainder) / logs_per_page + 1;
+	} else {
+		page = at / logs_per_page;
 	}
-	return *log;
+	current_page = pages() - page - 1;
+	return at;
 }
 
 std::string tchat_::err_encode_str;
@@ -376,6 +400,7 @@ tchat_::tchat_(display& disp, int chat_page)
 	, page_panel_(NULL)
 	, current_ft_(ft_none)
 	, in_find_chan_(false)
+	, chanlist_dirty_(false)
 	, catalog_(NULL)
 	, toolbar_(NULL)
 	, swap_resultion_(false)
@@ -389,6 +414,9 @@ tchat_::tchat_(display& disp, int chat_page)
 	, remote_size_(-1, -1)
 	, local_pixels_(NULL)
 	, local_size_(-1, -1)
+	, yuv_texture_(renderer_support_texture_format(get_renderer(), SDL_PIXELFORMAT_IYUV))
+	, remote_angle_(0)
+	, local_angle_(0)
 	, local_render_size_(capture_size)
 	, original_local_offset_(0, 0)
 	, current_local_offset_(0, 0)
@@ -437,6 +465,7 @@ void tchat_::pre_create_renderer()
 		remote_tex_ = NULL;
 		remote_size_ = tpoint(twidget::npos, twidget::npos);
 		remote_pixels_ = NULL;
+		remote_frame_ = NULL;
 	}
 
 	if (local_tex_.get() != NULL) {
@@ -444,6 +473,7 @@ void tchat_::pre_create_renderer()
 		local_tex_ = NULL;
 		local_size_ = tpoint(twidget::npos, twidget::npos);
 		local_pixels_ = NULL;
+		local_frame_ = NULL;
 	}
 }
 
@@ -451,6 +481,12 @@ void tchat_::post_create_renderer()
 {
 	VALIDATE(remote_tex_.get() == NULL && local_tex_.get() == NULL, null_str);
 
+	yuv_texture_ = renderer_support_texture_format(get_renderer(), SDL_PIXELFORMAT_IYUV);
+	if (yuv_texture_) {
+		// yuv texture is created on first frame, size of it is frame's size.
+		return;
+	}
+
 	// if (!deconstructed_) {
 	{
 		threading::lock lock(remote_mutex_);
@@ -1084,10 +1120,10 @@ void tchat_::refresh_toolbar(int type, int id)
 		bool active = true;
 		toolbar_->set_child_visible(n, func.type & type);
 		if (func.id == f_copy) {
-			active = current_session_ && (!current_session_->history.empty() || !current_session_->receiver->logs.empty());
+			active = current_session_ && current_session_->size();
 
 		} else if (func.id == f_reply) {
-			active = current_session_ && (!current_session_->history.empty() || !current_session_->receiver->logs.empty());
+			active = current_session_ && current_session_->size();
 			if (active) {
 				const std::string& my_nick = lobby->chat->me? lobby->chat->me->nick: lobby->nick();
 				twidget* panel = history_->cursel();
@@ -1533,6 +1569,60 @@ void tchat_::set_renderer_texture_size(bool remote, int width, int height)
 	SDL_LockTexture(tex.get(), NULL, (void**)pixels, &pitch);
 }
 
+void tchat_::set_yuv_frame(bool remote, const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& buffer, int angle)
+{
+	// caller must hold get_mutex(remote).
+	if (remote) {
+		remote_frame_ = buffer;
+		remote_angle_ = angle;
+	} else {
+		local_frame_ = buffer;
+		local_angle_ = angle;
+	}
+}
+
+void tchat_::render_video_texture(SDL_Renderer* renderer, bool remote, const SDL_Rect& dst)
+{
+	threading::lock lock(get_mutex(remote));
+	texture& tex = remote? remote_tex_: local_tex_;
+
+	if (!yuv_texture_) {
+		VideoRenderer* video_renderer = remote? remote_renderer_.get(): local_renderer_.get();
+		if (video_renderer->dirty()) {
+			SDL_UnlockTexture(tex.get());
+		}
+		SDL_RenderCopy(renderer, tex.get(), NULL, &dst);
+		return;
+	}
+
+	rtc::scoped_refptr<webrtc::VideoFrameBuffer>& frame = remote? remote_frame_: local_frame_;
+	if (frame.get()) {
+		tpoint& size = remote? remote_size_: local_size_;
+		if (tex.get() == NULL || frame->width() != size.x || frame->height() != size.y) {
+			size.x = frame->width();
+			size.y = frame->height();
+			tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_IYUV, SDL_TEXTUREACCESS_STREAMING, size.x, size.y);
+		}
+		SDL_UpdateYUVTexture(tex.get(), NULL, frame->DataY(), frame->StrideY(), frame->DataU(), frame->StrideU(), frame->DataV(), frame->StrideV());
+		// release buffer to webrtc's pool as soon as possible.
+		frame = NULL;
+	}
+	if (tex.get() == NULL) {
+		return;
+	}
+
+	const int angle = remote? remote_angle_: local_angle_;
+	if (angle % 180) {
+		// SDL_RenderCopyEx rotate around center of dstrect. to cover dst after rotated, swap width and height.
+		SDL_Rect dst2 = ::create_rect(dst.x + (dst.w - dst.h) / 2, dst.y + (dst.h - dst.w) / 2, dst.h, dst.w);
+		SDL_RenderCopyEx(renderer, tex.get(), NULL, &dst2, angle, NULL, SDL_FLIP_NONE);
+	} else {
+		SDL_RenderCopyEx(renderer, tex.get(), NULL, &dst, angle, NULL, SDL_FLIP_NONE);
+	}
+}
+
+enum {overlay_remote_text, overlay_icon, overlay_local_text};
+
 void tchat_::did_draw_vrenderer(ttrack& widget, const SDL_Rect& widget_rect, const bool bg_drawn, bool force)
 {
 	if (widget_rect.x == -1 && widget_rect.y == -1) {
@@ -1549,7 +1639,6 @@ void tchat_::did_draw_vrenderer(ttrack& widget, const SDL_Rect& widget_rect, con
 		SDL_RenderCopy(renderer, widget.background_texture().get(), NULL, &widget_rect);
 	}
 
-	surface text_surf;
 	SDL_Rect dst;
 	VideoRenderer* local_renderer = local_renderer_.get();
 	VideoRenderer* remote_renderer = remote_renderer_.get();
@@ -1558,27 +1647,18 @@ void tchat_::did_draw_vrenderer(ttrack& widget, const SDL_Rect& widget_rect, con
 	bool require_render_remote = remote_renderer != NULL && (remote_renderer->dirty() || require_render_local || force);
 
 	if (require_render_remote) {
-		threading::lock lock(remote_mutex_);
-		if (remote_renderer->dirty()) {
-			SDL_UnlockTexture(remote_tex_.get());
-		}
-
-		SDL_RenderCopy(renderer, remote_tex_.get(), NULL, &widget_rect);
+		render_video_texture(renderer, true, widget_rect);
 
-		text_surf = font::get_rendered_text2(_("Remote video"), -1, 48, font::BAD_COLOR);
-		dst = ::create_rect(widget_rect.x, widget_rect.y, text_surf->w, text_surf->h);
-		render_surface(renderer, text_surf, NULL, &dst);
+		const std::string remote_text = _("Remote video");
+		const ttrack::toverlay& text_overlay = widget.overlay(overlay_remote_text, remote_text,
+			boost::bind(&font::get_rendered_text2, remote_text, -1, 48, font::BAD_COLOR, false));
+		widget.draw_overlay(renderer, text_overlay, widget_rect.x, widget_rect.y);
 
-		surface surf = image::get_image("misc/chat.png");
-		dst = ::create_rect(widget_rect.x, widget_rect.y + widget_rect.h - surf->h, surf->w, surf->h);
-		render_surface(renderer, surf, NULL, &dst);
+		const std::string icon = "misc/chat.png";
+		const ttrack::toverlay& icon_overlay = widget.overlay(overlay_icon, icon, boost::bind(&image::get_image, image::locator(icon)));
+		widget.draw_overlay(renderer, icon_overlay, widget_rect.x, widget_rect.y + widget_rect.h - icon_overlay.h);
 	}
 	if (require_render_local) {
-		threading::lock lock(local_mutex_);
-		if (local_renderer->dirty()) {
-			SDL_UnlockTexture(local_tex_.get());
-		}
-
 		if (local_render_size_.x * 2 > widget_rect.w) {
 			local_render_size_.x /= 2;
 			local_render_size_.y /= 2;
@@ -1588,12 +1668,12 @@ void tchat_::did_draw_vrenderer(ttrack& widget, const SDL_Rect& widget_rect, con
 		dst.x = widget_rect.x + original_local_offset_.x + current_local_offset_.x;
 		dst.y = widget_rect.y + original_local_offset_.y + current_local_offset_.y;
 
-		SDL_RenderCopy(renderer, local_tex_.get(), NULL, &dst);
+		render_video_texture(renderer, false, dst);
 
-		text_surf = font::get_rendered_text2(_("Local video"), -1, 36, font::GOOD_COLOR);
-		dst.w = text_surf->w;
-		dst.h = text_surf->h;
-		render_surface(renderer, text_surf, NULL, &dst);
+		const std::string local_text = _("Local video");
+		const ttrack::toverlay& text_overlay = widget.overlay(overlay_local_text, local_text,
+			boost::bind(&font::get_rendered_text2, local_text, -1, 36, font::GOOD_COLOR, false));
+		widget.draw_overlay(renderer, text_overlay, dst.x, dst.y);
 	}
 }
 
@@ -1955,28 +2035,15 @@ void tchat_::process_message(const std::string& chan, const std::string& from, c
 
 void tchat_::process_userlist(const std::string& chan, const std::string& names)
 {
-	std::vector<std::string> vstr = utils::split(names, ' ');
 	tlobby_channel& channel = lobby->chat->get_channel(tlobby_channel::get_cid(chan));
 
 	if (!channel.users_receiving) {
 		clear_branch(false, channel.cid);
 	}
 
-	std::vector<tcookie>& branch = channel_cookies_.find(channel.cid)->second;
-	char* nick_prefixes = lobby->chat->serv()->nick_prefixes;
-	std::string nopre_nick;
-	for (std::vector<std::string>::const_iterator it = vstr.begin(); it != vstr.end(); ++ it) {
-		const std::string& nick = *it;
-		nopre_nick = *it;
-		// Ignore prefixes so '!' won't cause issues
-		if (strchr(nick_prefixes, nopre_nick[0])) {
-			nopre_nick = nopre_nick.substr(1);
-		}
-
-		int uid = tlobby_user::get_uid(nopre_nick);
-		const tlobby_user& user = channel.get_user(uid);
-		insert_user(false, branch, user);
-	}
+	// users has been inserted into channel by tchat_sock. big channel receive thousands of NAMREPLAY,
+	// update branch node once at handle_pump.
+	dirty_channels_.insert(channel.cid);
 }
 
 void tchat_::process_userlist_end(const std::string& chan)
@@ -2178,6 +2245,8 @@ void tchat_::process_chanlist_start()
 {
 	in_find_chan_ = true;
 	list_chans_.clear();
+	list_chans_set_.clear();
+	chanlist_dirty_ = false;
 	chanlist_->clear();
 	tlabel& label = find_widget<tlabel>(window_, "_chat_find_result", false);
 	label.set_label("0/0");
@@ -2195,11 +2264,10 @@ void tchat_::process_chanlist(const std::string& chan, int users, const std::str
 		return;
 	}
 
-	if (std::find(list_chans_.begin(), list_chans_.end(), chan) == list_chans_.end()) {
-		list_chans_.push_back(chan);
-	} else {
+	if (!list_chans_set_.insert(chan).second) {
 		return;
 	}
+	list_chans_.push_back(chan);
 	if (list_chans_.size() <= 100) {
 		std::map<std::string, std::string> list_item_item;
 
@@ -2210,11 +2278,17 @@ void tchat_::process_chanlist(const std::string& chan, int users, const std::str
 
 		chanlist_->insert_row(list_item_item);
 	}
+	chanlist_dirty_ = true;
+}
 
+void tchat_::update_chanlist_result()
+{
 	std::stringstream ss;
 	ss << chanlist_->rows() << "/" << list_chans_.size();
 	tlabel& label = find_widget<tlabel>(window_, "_chat_find_result", false);
 	label.set_label(ss.str());
+
+	chanlist_dirty_ = false;
 }
 
 void tchat_::process_chanlist_end()
@@ -2224,6 +2298,9 @@ void tchat_::process_chanlist_end()
 	}
 
 	in_find_chan_ = false;
+	if (chanlist_dirty_) {
+		update_chanlist_result();
+	}
 	chanlist_->invalidate_layout();
 
 	switch_to_chat_find_->set_active(true);
@@ -2424,6 +2501,28 @@ bool tchat_::handle_raw(int at, tsock::ttype type, const char* param[])
 	return halt;
 }
 
+void tchat_::handle_pump()
+{
+	if (!gui_ready()) {
+		dirty_channels_.clear();
+		chanlist_dirty_ = false;
+		return;
+	}
+
+	for (std::set<int>::const_iterator it = dirty_channels_.begin(); it != dirty_channels_.end(); ++ it) {
+		std::map<int, std::vector<tcookie> >::iterator find_it = channel_cookies_.find(*it);
+		if (find_it != channel_cookies_.end()) {
+			std::vector<tcookie>& branch = find_it->second;
+			update_node_internal(branch, branch.front());
+		}
+	}
+	dirty_channels_.clear();
+
+	if (chanlist_dirty_) {
+		update_chanlist_result();
+	}
+}
+
 void tchat_::swap_page(twindow& window, int layer, bool swap)
 {
 	if (!page_panel_) {
@@ -3275,7 +3374,8 @@ tchat_::VideoRenderer::VideoRenderer(tchat_* chat, int width, int height, webrtc
 	, bytesperpixel_(4)
 {
 	rtc::VideoSinkWants wants;
-	wants.rotation_applied = true;
+	// yuv texture rotate by renderer, let source skip rotating copy.
+	wants.rotation_applied = !chat_->yuv_texture();
 	rendered_track_->AddOrUpdateSink(this, wants);
 }
 
@@ -3298,6 +3398,18 @@ void tchat_::VideoRenderer::OnFrame(const webrtc::VideoFrame& video_frame)
 		} else {
 			buffer = video_frame.video_frame_buffer();
 		}
+		if (chat_->yuv_texture()) {
+			// no cpu conversion/rotation, texture upload and rotation are done in did_draw_vrenderer.
+			int angle = video_frame.rotation();
+			const int rotated_width = angle % 180? buffer->height(): buffer->width();
+			if (rotated_width != capture_size.x) {
+				angle = (angle + 90) % 360;
+			}
+			chat_->set_yuv_frame(remote_, buffer, angle);
+			dirty_ = true;
+			return;
+		}
+
 		if (video_frame.rotation() != webrtc::kVideoRotation_0) {
 			buffer = webrtc::I420Buffer::Rotate(buffer, video_frame.rotation());
 		}	
@@ -103,14 +103,26 @@ public:
 		tsession(chat_logs::treceiver& receiver);
 
 		int current_logs(std::vector<chat_logs::tlog>& logs) const;
+		int size() const { return (int)history.size() + receiver->size(); }
 		int pages() const;
 		bool can_previous() const;
 		bool can_next() const;
 		const chat_logs::tlog& log(int at) const;
+		// switch current_page to page of this hit. return index of hit's log, npos if not in this session.
+		int locate(const chat_logs::tsearch_hit& hit);
 
 		chat_logs::treceiver* receiver;
-		std::vector<chat_logs::tlog> history;
+		chat_logs::thistory_log history_log;
+		// offset of every log in history.log, log is read when its page is required.
+		std::vector<int> history;
 		int current_page;
+
+	private:
+		void read_logs(int start, int end, std::vector<chat_logs::tlog>& logs) const;
+
+	private:
+		mutable std::vector<chat_logs::tlog> page_logs_;
+		mutable int page_start_;
 	};
 
 	tchat_(display& disp, int chat_page);
@@ -118,6 +130,7 @@ public:
 
 	virtual void handle_status(int at, tsock::ttype type) override;
 	virtual bool handle_raw(int at, tsock::ttype type, const char* param[]) override;
+	void handle_pump() override;
 
 	void pre_create_renderer();
 	void post_create_renderer();
@@ -127,6 +140,8 @@ public:
 	void did_drag_coordinate(ttrack& widget, const tpoint& first, const tpoint& last);
 	ttrack* vrenderer_track() const { return vrenderer_track_; }
 	uint8_t* pixels(bool remote) const { return remote? remote_pixels_: local_pixels_; }
+	bool yuv_texture() const { return yuv_texture_; }
+	void set_yuv_frame(bool remote, const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& buffer, int angle);
 
 protected:
 	/** Inherited from tdialog. */
@@ -146,6 +161,7 @@ protected:
 	void process_chanlist_start();
 	void process_chanlist(const std::string& chan, int users, const std::string& topic);
 	void process_chanlist_end();
+	void update_chanlist_result();
 	void process_online(const char* nicks);
 	void process_offline(const char* nicks);
 	void process_forbid_join(const std::string& chan, const std::string& reason);
@@ -296,6 +312,7 @@ private:
 
 	threading::mutex& get_mutex(bool remote) { return remote? remote_mutex_: local_mutex_; }
 	void set_renderer_texture_size(bool remote, int width, int height);
+	void render_video_texture(SDL_Renderer* renderer, bool remote, const SDL_Rect& dst);
 	
 	int AddRef() const override;
 	int Release() const override;
@@ -362,6 +379,10 @@ private:
 	bool in_find_chan_;
 	int cond_min_users_;
 	std::vector<std::string> list_chans_;
+	std::set<std::string> list_chans_set_;
+	bool chanlist_dirty_;
+	// channels whose branch node require update at end of this pump.
+	std::set<int> dirty_channels_;
 
 	int src_pos_;
 	int chat_page_;
@@ -445,6 +466,14 @@ private:
 	uint8_t* remote_pixels_;
 	uint8_t* local_pixels_;
 
+	// renderer accept SDL_PIXELFORMAT_IYUV. frames are uploaded as-is,
+	// and rotation is done by SDL_RenderCopyEx.
+	bool yuv_texture_;
+	rtc::scoped_refptr<webrtc::VideoFrameBuffer> remote_frame_;
+	rtc::scoped_refptr<webrtc::VideoFrameBuffer> local_frame_;
+	int remote_angle_;
+	int local_angle_;
+
 	mutable volatile int ref_count_;
 
 	char* send_data_;
@@ -108,6 +108,14 @@ public:
 		return grid_->find_at(coordinate, must_be_active); 
 	}
 
+	void collect_hit_widgets(std::vector<thit_widget>& widgets) override
+	{
+		if (visible_ != VISIBLE) {
+			return;
+		}
+		grid_->collect_hit_widgets(widgets);
+	}
+
 	/** Inherited from tcontrol.*/
 	twidget* find(const std::string& id, const bool must_be_active)
 	{
@@ -128,7 +128,11 @@ void tcontrol::layout_init(bool linked_group_only)
 {
 	// Inherited.
 	twidget::layout_init(linked_group_only);
-	if (!linked_group_only) {
+	if (!linked_group_only && text_maximum_width_) {
+		// before fill_placeable_width, restrict_width's label has no size.
+		if (restrict_width_) {
+			invalidate_best_size();
+		}
 		text_maximum_width_ = 0;
 	}
 }
@@ -322,6 +326,7 @@ void tcontrol::set_best_size(const std::string& width, const std::string& height
 {
 	best_width_ = tformula<unsigned>(width);
 	best_height_ = tformula<unsigned>(height);
+	invalidate_best_size();
 }
 
 void tcontrol::set_label(const std::string& label)
@@ -332,6 +337,7 @@ void tcontrol::set_label(const std::string& label)
 
 	label_ = label;
 	label_size_.second.x = 0;
+	invalidate_best_size();
 	update_canvas();
 	set_dirty();
 
@@ -353,7 +359,7 @@ void tcontrol::update_canvas()
 {
 	// set label in canvases
 	BOOST_FOREACH(tcanvas& canvas, canvas_) {
-		canvas.set_variable("text", variant(label_));
+		canvas.set_variable(game_logic::slot_text, variant(label_));
 	}
 }
 
@@ -365,7 +371,11 @@ int tcontrol::get_text_maximum_width() const
 void tcontrol::set_text_maximum_width(int maximum)
 {
 	if (restrict_width_) {
-		text_maximum_width_ = maximum - config_->text_extra_width;
+		const int text_maximum_width = maximum - config_->text_extra_width;
+		if (text_maximum_width != text_maximum_width_) {
+			text_maximum_width_ = text_maximum_width;
+			invalidate_best_size();
+		}
 	}
 }
 
@@ -33,6 +33,11 @@ tgrid::tgrid(const unsigned rows, const unsigned cols)
 	, cols_(cols)
 	, row_height_()
 	, col_width_()
+	, best_size_cache_(0, 0)
+	, cached_row_height_()
+	, cached_col_width_()
+	, cached_children_vsize_(0)
+	, cached_generation_(0)
 	, row_grow_factor_(rows)
 	, col_grow_factor_(cols)
 	, children_(NULL)
@@ -112,6 +117,7 @@ void tgrid::set_child(twidget* widget, const unsigned row,
 		// make sure the new child is valid before deferring
 		cell.widget_->set_parent(this);
 	}
+	invalidate_best_size();
 }
 
 twidget* tgrid::swap_child(
@@ -145,6 +151,7 @@ twidget* tgrid::swap_child(
 
 		widget->set_parent(this);
 		child.widget_ = widget;
+		invalidate_best_size();
 
 		return old;
 	}
@@ -162,6 +169,7 @@ void tgrid::remove_child(const unsigned row, const unsigned col)
 		delete cell.widget_;
 	}
 	cell.widget_ = NULL;
+	invalidate_best_size();
 }
 
 void tgrid::remove_child(const std::string& id, const bool find_all)
@@ -172,6 +180,7 @@ void tgrid::remove_child(const std::string& id, const bool find_all)
 		if (child.widget_->id() == id) {
 			delete child.widget_;
 			child.widget_ = NULL;
+			invalidate_best_size();
 
 			if (!find_all) {
 				break;
@@ -243,6 +252,16 @@ void tgrid::layout_init(bool linked_group_only)
 
 tpoint tgrid::calculate_best_size() const
 {
+	// inside twindow::layout, size of children doesn't change unless someone invalidate it.
+	// the cache survives between layouts, invalidate_best_size marks only the changed path.
+	const bool use_cache = best_size_cache_enabled && !clear_restrict_width_cell_size;
+	if (use_cache && best_size_cached_ && cached_generation_ == best_size_generation && cached_children_vsize_ == children_vsize_
+		&& cached_row_height_.size() == rows_ && cached_col_width_.size() == cols_) {
+		row_height_ = cached_row_height_;
+		col_width_ = cached_col_width_;
+		return best_size_cache_;
+	}
+
 	// Reset the cached values.
 	row_height_.clear();
 	row_height_.resize(rows_, 0);
@@ -269,6 +288,15 @@ tpoint tgrid::calculate_best_size() const
 		std::accumulate(col_width_.begin(), col_width_.end(), 0),
 		std::accumulate(row_height_.begin(), row_height_.end(), 0));
 
+	if (use_cache) {
+		best_size_cache_ = result;
+		cached_row_height_ = row_height_;
+		cached_col_width_ = col_width_;
+		cached_children_vsize_ = children_vsize_;
+		cached_generation_ = best_size_generation;
+		best_size_cached_ = true;
+	}
+
 	return result;
 }
 
@@ -582,6 +610,21 @@ twidget* tgrid::find_at(const tpoint& coordinate, const bool must_be_active)
 	return nullptr;
 }
 
+void tgrid::collect_hit_widgets(std::vector<thit_widget>& widgets)
+{
+	if (visible_ != VISIBLE) {
+		return;
+	}
+
+	for (int n = 0; n < children_vsize_; n ++) {
+		const tchild& child = children_[n];
+		if (child.widget_->get_visible() != VISIBLE) {
+			continue;
+		}
+		child.widget_->collect_hit_widgets(widgets);
+	}
+}
+
 twidget* tgrid::find(const std::string& id, const bool must_be_active)
 {
 	twidget* widget = twidget::find(id, must_be_active);
@@ -682,6 +725,7 @@ void tgrid::set_rows_cols(const unsigned rows, const unsigned cols)
 	col_grow_factor_.resize(cols);
 	resize_children((rows * cols) + 1);
 	children_vsize_ = rows * cols;
+	invalidate_best_size();
 }
 
 tpoint cell_get_best_size(const tgrid::tchild& cell)
@@ -212,6 +212,7 @@ public:
 
 	/** Inherited from twidget. */
 	twidget* find_at(const tpoint& coordinate, const bool must_be_active) override;
+	void collect_hit_widgets(std::vector<thit_widget>& widgets) override;
 
 	/** Inherited from twidget.*/
 	twidget* find(const std::string& id, const bool must_be_active);
@@ -303,6 +304,13 @@ protected:
 	/** The column widths in the grid. */
 	mutable std::vector<unsigned> col_width_;
 
+	/** Result of last calculate_best_size, valid when best_size_cached_ is true. */
+	mutable tpoint best_size_cache_;
+	mutable std::vector<unsigned> cached_row_height_;
+	mutable std::vector<unsigned> cached_col_width_;
+	mutable int cached_children_vsize_;
+	mutable unsigned cached_generation_;
+
 	/** The grow factor for all rows. */
 	std::vector<unsigned> row_grow_factor_;
 
@@ -73,11 +73,11 @@ t_string missing_widget(const std::string& id)
 
 void get_screen_size_variables(game_logic::map_formula_callable& variable)
 {
-	variable.add("screen_width", variant(settings::screen_width / twidget::hdpi_scale));
-	variable.add("screen_height", variant(settings::screen_height / twidget::hdpi_scale));
-	variable.add("svga", variant(game_config::svga));
-	variable.add("vga", variant((int)settings::screen_width >= 640 * twidget::hdpi_scale && (int)settings::screen_height >= 480 * twidget::hdpi_scale));
-	variable.add("mobile", variant(game_config::mobile));
+	variable.add(game_logic::slot_screen_width, variant(settings::screen_width / twidget::hdpi_scale));
+	variable.add(game_logic::slot_screen_height, variant(settings::screen_height / twidget::hdpi_scale));
+	variable.add(game_logic::slot_svga, variant(game_config::svga));
+	variable.add(game_logic::slot_vga, variant((int)settings::screen_width >= 640 * twidget::hdpi_scale && (int)settings::screen_height >= 480 * twidget::hdpi_scale));
+	variable.add(game_logic::slot_mobile, variant(game_config::mobile));
 }
 
 game_logic::map_formula_callable get_screen_size_variables()
@@ -229,6 +229,9 @@ int tlistbox::which_children_row_gc(const int distance) const
 
 int tlistbox::mini_handle_gc(const int x_offset, const int y_offset)
 {
+	// gc_first_at_/gc_last_at_ maybe change, they decide rows find_at can see.
+	geometry_version ++;
+
 	const int rows = list_grid_->children_vsize();
 	if (!rows) {
 		return y_offset;
@@ -865,6 +868,8 @@ void tlistbox::cancel_drag()
 // caller will erase or insert row. havn't erase it, but have inserted it.
 void tlistbox::gc_insert_or_erase_row(const int row, const bool insert)
 {
+	geometry_version ++;
+
 	const int rows = list_grid_->children_vsize();
 	tgrid::tchild* children = list_grid_->children();
 
@@ -1046,6 +1051,8 @@ void tlistbox::erase_row(int at)
 
 void tlistbox::clear()
 {
+	geometry_version ++;
+
 	const int rows = list_grid_->children_vsize();
 	if (!rows) {
 		return;
@@ -1079,6 +1086,8 @@ private:
 
 void tlistbox::sort(const boost::function<bool (const ttoggle_panel& widget, const ttoggle_panel&)>& did_compare)
 {
+	geometry_version ++;
+
 	tgrid::tchild* children = list_grid_->children();
 	const int rows = list_grid_->children_vsize();
 
@@ -1476,6 +1485,18 @@ twidget* tlistbox::find_at(const tpoint& coordinate, const bool must_be_active)
 	return result;
 }
 
+void tlistbox::collect_hit_widgets(std::vector<thit_widget>& widgets)
+{
+	if (visible_ != VISIBLE) {
+		return;
+	}
+
+	if (left_drag_grid_ && left_drag_grid_->get_visible() == twidget::VISIBLE) {
+		left_drag_grid_->collect_hit_widgets(widgets);
+	}
+	tscroll_container::collect_hit_widgets(widgets);
+}
+
 void tlistbox::child_populate_dirty_list(twindow& caller, const std::vector<twidget*>& call_stack)
 {
 	if (left_drag_grid_ && drag_at_ != twidget::npos) {
@@ -1909,6 +1930,7 @@ int tlistbox::tgrid3::listbox_insert_child(twidget& widget, int at)
 
 	// replacement
 	children_[at].flags_ = VERTICAL_ALIGN_TOP | HORIZONTAL_GROW_SEND_TO_CLIENT;
+	invalidate_best_size();
 
 	for (int at2 = at + 1; at2 < children_vsize_; at2 ++) {
 		ttoggle_panel* widget = dynamic_cast<ttoggle_panel*>(children_[at2].widget_);
@@ -1941,6 +1963,7 @@ void tlistbox::tgrid3::listbox_erase_child(int at)
 	rows_ --;
 	row_grow_factor_.pop_back();
 	row_height_.pop_back();
+	invalidate_best_size();
 
 	for (int at2 = at; at2 < children_vsize_; at2 ++) {
 		ttoggle_panel* widget = dynamic_cast<ttoggle_panel*>(children_[at2].widget_);
@@ -2217,6 +2240,21 @@ twidget* tlistbox::tgrid3::find_at(const tpoint& coordinate, const bool must_be_
 	return nullptr;
 }
 
+void tlistbox::tgrid3::collect_hit_widgets(std::vector<thit_widget>& widgets)
+{
+	if (visible_ != VISIBLE || !children_vsize_) {
+		return;
+	}
+
+	for (int row = listbox_.gc_first_at_; row <= listbox_.gc_last_at_; row ++) {
+		const tchild& child = children_[row];
+		if (child.widget_->get_visible() != VISIBLE) {
+			continue;
+		}
+		child.widget_->collect_hit_widgets(widgets);
+	}
+}
+
 void tlistbox::tgrid3::layout_children()
 {
 	if (!children_vsize_) {
@@ -2308,6 +2346,8 @@ void tlistbox::mini_more_items()
 
 tpoint tlistbox::mini_calculate_content_grid_size(const tpoint& content_origin, const tpoint& content_size)
 {
+	geometry_version ++;
+
 	const int rows = list_grid_->children_vsize();
 	if (rows) {
 		if (left_drag_grid_ && drag_at_ != twidget::npos) {
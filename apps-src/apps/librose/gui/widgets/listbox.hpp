@@ -53,6 +53,7 @@ public:
 		void impl_draw_children(texture& frame_buffer, int x_offset, int y_offset) override;
 		void dirty_under_rect(const SDL_Rect& clip) override;
 		twidget* find_at(const tpoint& coordinate, const bool must_be_active) override;
+		void collect_hit_widgets(std::vector<thit_widget>& widgets) override;
 		void layout_children() override;
 		void child_populate_dirty_list(twindow& caller, const std::vector<twidget*>& call_stack) override;
 
@@ -218,6 +219,7 @@ protected:
 
 	/** Inherited from tcontainer_. */
 	twidget* find_at(const tpoint& coordinate, const bool must_be_active) override;
+	void collect_hit_widgets(std::vector<thit_widget>& widgets) override;
 
 	/** Inherited from tcontainer_. */
 	void child_populate_dirty_list(twindow& caller,	const std::vector<twidget*>& call_stack) override;
@@ -1172,6 +1172,7 @@ void treport::tgrid2::insert_child(twidget& widget, int at)
 
 	children_[at].widget_ = &widget;
 	children_vsize_ ++;
+	invalidate_best_size();
 
 	report_.invalidate(widget);
 }
@@ -1193,6 +1194,7 @@ void treport::tgrid2::erase_child(int at)
 	}
 	children_[children_vsize_ - 1].widget_ = NULL;
 	children_vsize_ --;
+	invalidate_best_size();
 
 	// it must be same-size, to save time, don't calcuate linked_group.
 	report_.invalidate_layout();
@@ -1221,6 +1223,7 @@ void treport::tgrid2::erase_children()
 	if (!report_.multi_line_) {
 		col_width_.resize(cols_);
 	}
+	invalidate_best_size();
 
 	// it must be same-size, to save time, don't calcuate linked_group.
 	report_.invalidate_layout();
@@ -309,6 +309,37 @@ twidget* tscroll_container::find_at(const tpoint& coordinate, const bool must_be
 	return result;
 }
 
+void tscroll_container::collect_hit_widgets(std::vector<thit_widget>& widgets)
+{
+	if (visible_ != VISIBLE) {
+		return;
+	}
+
+	std::vector<thit_widget> container_widgets;
+	tcontainer_::collect_hit_widgets(container_widgets);
+	for (std::vector<thit_widget>::const_iterator it = container_widgets.begin(); it != container_widgets.end(); ++ it) {
+		if (it->first == content_) {
+			// like find_at, content_grid_'s children can be hit only in content_.
+			const SDL_Rect content_rect = content_->get_rect();
+			const size_t start = widgets.size();
+			content_grid_->collect_hit_widgets(widgets);
+			for (size_t at = start; at < widgets.size(); at ++) {
+				thit_widget& item = widgets[at];
+				if (!item.clipped) {
+					item.clip = content_rect;
+					item.clipped = true;
+				} else if (!SDL_IntersectRect(&item.clip, &content_rect, &item.clip)) {
+					item.clip = empty_rect;
+				}
+			}
+			// "empty" area of content.
+			widgets.push_back(thit_widget(content_grid_, content_));
+		} else {
+			widgets.push_back(*it);
+		}
+	}
+}
+
 twidget* tscroll_container::find(const std::string& id, const bool must_be_active)
 {
 	// Inherited.
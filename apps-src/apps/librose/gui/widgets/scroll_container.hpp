@@ -144,6 +144,7 @@ protected:
 
 	/** Inherited from tcontainer_. */
 	twidget* find_at(const tpoint& coordinate, const bool must_be_active) override;
+	void collect_hit_widgets(std::vector<thit_widget>& widgets) override;
 
 	/** Inherited from tcontainer_. */
 	bool disable_click_dismiss() const;
@@ -25,6 +25,7 @@
 #include "config_cache.hpp"
 #include "filesystem.hpp"
 #include "gettext.hpp"
+#include "gui/auxiliary/log.hpp"
 #include "gui/widgets/window.hpp"
 #include "serialization/parser.hpp"
 #include "formula_string_utils.hpp"
@@ -208,15 +209,25 @@ const std::string& tgui_definition::read(const config& cfg)
 				  , const config&
 				  , const char *key)> > thack;
 
+	// definitions are loaded at first get_control of this type.
+	definition_cfg_ = &cfg;
+	control_definition.clear();
+	unresolved_controls_.clear();
 	BOOST_FOREACH(thack& widget_type, registred_widget_type()) {
-		widget_type.second(*this, widget_type.first, cfg, NULL);
+		unresolved_controls_.insert(widget_type.first);
 	}
 
 	/***** Window types *****/
+	// only record [window], builder is parsed at first get_window_builder.
+	window_types.clear();
+	window_cfgs.clear();
 	BOOST_FOREACH (const config &w, cfg.child_range("window")) {
-		std::pair<std::string, twindow_builder> child;
-		child.first = child.second.read(w);
-		window_types.insert(child);
+		const std::string id = w["id"].str();
+		const std::string app = w["app"].str();
+		VALIDATE(!id.empty(), missing_mandatory_wml_key("window", "id"));
+		VALIDATE(!app.empty(), missing_mandatory_wml_key("window", "app"));
+
+		window_cfgs.insert(std::make_pair(utils::generate_app_prefix_id(app, id), &w));
 	}
 
 	if (id == "default") {
@@ -231,7 +242,7 @@ const std::string& tgui_definition::read(const config& cfg)
                                          *itor +
                                          "'. Perhaps a mismatch between data and source versions."
                                          " Try --data-dir <trunk-dir>" );
-			VALIDATE(window_types.find(*itor) != window_types.end(), error_msg );
+			VALIDATE(window_cfgs.find(*itor) != window_cfgs.end(), error_msg );
 		}
 	}
 
@@ -316,6 +327,43 @@ const std::string& tgui_definition::read(const config& cfg)
 	return id;
 }
 
+const twindow_builder* tgui_definition::window_builder(const std::string& type)
+{
+	std::map<std::string, twindow_builder>::const_iterator it = window_types.find(type);
+	if (it != window_types.end()) {
+		return &it->second;
+	}
+
+	std::map<std::string, const config*>::const_iterator cfg_it = window_cfgs.find(type);
+	if (cfg_it == window_cfgs.end()) {
+		return NULL;
+	}
+
+	std::pair<std::string, twindow_builder> child;
+	child.first = child.second.read(*cfg_it->second);
+	return &window_types.insert(child).first->second;
+}
+
+void tgui_definition::resolve_control_definition(const std::string& type)
+{
+	std::set<std::string>::iterator it = unresolved_controls_.find(type);
+	if (it == unresolved_controls_.end()) {
+		return;
+	}
+	// erase first, definition of this type maybe require other type.
+	unresolved_controls_.erase(it);
+
+	tregistered_widget_type::const_iterator functor = registred_widget_type().find(type);
+	functor->second(*this, type, *definition_cfg_, NULL);
+}
+
+void tgui_definition::resolve_all_control_definitions()
+{
+	while (!unresolved_controls_.empty()) {
+		resolve_control_definition(*unresolved_controls_.begin());
+	}
+}
+
 void tgui_definition::activate() const
 {
 	settings::double_click_time = double_click_time_;
@@ -382,8 +430,10 @@ void load_settings()
 	// Init.
 	twindow::update_screen_size();
 
-	// Read file.
-	config cfg;
+	const uint32_t start_ticks = SDL_GetTicks();
+
+	// Read file. gui retain it, window and control definitions are parsed on demand.
+	config& cfg = gui.cfg;
 	try {
 		wml_config_from_file(game_config::path + "/xwml/" + "gui.bin", cfg);
 
@@ -397,6 +447,9 @@ void load_settings()
 
 	gui.read(gui_cfg);
 	gui.activate();
+
+	LOG_GUI_P << "load_settings, " << (SDL_GetTicks() - start_ticks) << " ms, deferred " << gui.window_cfgs.size()
+		<< " windows and " << registred_widget_type().size() << " control types.\n";
 }
 
 tstate_definition::tstate_definition(const config &cfg) :
@@ -449,6 +502,8 @@ void load_widget_definitions(
 tresolution_definition_ptr get_control(
 		const std::string& control_type, const std::string& definition)
 {
+	gui.resolve_control_definition(control_type);
+
 	const tgui_definition::tcontrol_definition_map::const_iterator
 	control_definition = gui.control_definition.find(control_type);
 
@@ -485,19 +540,19 @@ std::vector<twindow_builder::tresolution>::const_iterator get_window_builder(con
 {
 	twindow::update_screen_size();
 
-	std::map<std::string, twindow_builder>::const_iterator
-		window = gui.window_types.find(type);
-
-	if (window == gui.window_types.end()) {
+	const twindow_builder* window = gui.window_builder(type);
+	if (!window) {
 		throw twindow_builder_invalid_id();
 	}
 
-	VALIDATE(window->second.resolutions.size() == 1, null_str);
-	return window->second.resolutions.begin();
+	VALIDATE(window->resolutions.size() == 1, null_str);
+	return window->resolutions.begin();
 }
 
 bool valid_control_definition(const std::string& type, const std::string& definition)
 {
+	gui.resolve_control_definition(type);
+
 	const tgui_definition::tcontrol_definition_map& controls = gui.control_definition;
 	const std::map<std::string, tcontrol_definition_ptr>& map = controls.find(type)->second;
 
@@ -198,6 +198,10 @@ struct tgui_definition
 		, control_definition()
 		, windows()
 		, window_types()
+		, window_cfgs()
+		, cfg()
+		, definition_cfg_(NULL)
+		, unresolved_controls_()
 		, double_click_time_(0)
 		, sound_button_click_()
 		, sound_toggle_button_click_()
@@ -222,12 +226,30 @@ struct tgui_definition
 
 	std::map<std::string, twindow_definition> windows;
 
+	/** Parsed window builders, a window is parsed at first get_window_builder. */
 	std::map<std::string, twindow_builder> window_types;
 
+	/** All windows defined in gui, point to [window] in cfg. */
+	std::map<std::string, const config*> window_cfgs;
+
+	/** Retained gui.bin, windows and control definitions are parsed from it on demand. */
+	config cfg;
+
 	void load_widget_definitions(
 			  const std::string& definition_type
 			, const std::vector<tcontrol_definition_ptr>& definitions);
+
+	/** Returns builder of window type, parse it if required. NULL if not defined. */
+	const twindow_builder* window_builder(const std::string& type);
+
+	/** Loads definitions of control type if they haven't been loaded. */
+	void resolve_control_definition(const std::string& type);
+	void resolve_all_control_definitions();
+
 private:
+	const config* definition_cfg_;
+	std::set<std::string> unresolved_controls_;
+
 
 	unsigned double_click_time_;
 
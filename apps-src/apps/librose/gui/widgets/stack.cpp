@@ -184,6 +184,31 @@ twidget* tstack::find_at(const tpoint& coordinate, const bool must_be_active)
 	return NULL;
 }
 
+void tstack::collect_hit_widgets(std::vector<thit_widget>& widgets)
+{
+	tgrid::tchild* children = grid_.children();
+	int childs = grid_.children_vsize();
+
+	if (mode_ == pip) {
+		for (int n = childs - 1; n >= 0; n --) {
+			twidget* grid = children[n].widget_;
+			if (grid->get_visible() != twidget::VISIBLE) {
+				continue;
+			}
+			grid->collect_hit_widgets(widgets);
+			return;
+		}
+	} else {
+		for (int n = 0; n < childs; n ++) {
+			twidget* grid = children[n].widget_;
+			if (grid->get_visible() != twidget::VISIBLE) {
+				continue;
+			}
+			grid->collect_hit_widgets(widgets);
+		}
+	}
+}
+
 void tstack::tgrid2::stacked_init()
 {
 	VALIDATE(!children_vsize_, "Must no child in report!");
@@ -232,6 +257,7 @@ void tstack::tgrid2::stacked_insert_child(twidget& widget, int at, uint32_t fact
 
 	// replacement
 	children_[at].flags_ = VERTICAL_GROW_SEND_TO_CLIENT | HORIZONTAL_GROW_SEND_TO_CLIENT;
+	invalidate_best_size();
 }
 
 tpoint tstack::tgrid2::calculate_best_size() const
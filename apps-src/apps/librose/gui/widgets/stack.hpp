@@ -94,7 +94,7 @@ public:
 	/** Inherited from tcontrol. */
 	bool get_active() const { return true; }
 
-	void set_mode(tmode mode) { mode_ = mode; }
+	void set_mode(tmode mode) { mode_ = mode; geometry_version ++; }
 	tmode mode() const { return mode_; }
 
 	void set_radio_layer(int layer);
@@ -135,6 +135,7 @@ private:
 
 	/** Inherited from tcontrol. */
 	twidget* find_at(const tpoint& coordinate, const bool must_be_active) override;
+	void collect_hit_widgets(std::vector<thit_widget>& widgets) override;
 
 	/**
 	 * Finishes the building initialization of the widget.
@@ -56,6 +56,12 @@ public:
 		return result ? result : tcontrol::find_at(coordinate, must_be_active);
 	}
 
+	void collect_hit_widgets(std::vector<thit_widget>& widgets) override
+	{
+		tcontainer_::collect_hit_widgets(widgets);
+		tcontrol::collect_hit_widgets(widgets);
+	}
+
 	/** Inherited from tpanel. */
 	void set_active(const bool active);
 
@@ -119,6 +119,34 @@ SDL_Rect ttrack::get_draw_rect() const
 	return ::create_rect(x_, y_, w_, h_);
 }
 
+const ttrack::toverlay& ttrack::overlay(int layer, const std::string& key, const boost::function<surface ()>& create)
+{
+	toverlay& result = overlays_[layer];
+	if (result.tex.get() && result.key == key) {
+		return result;
+	}
+
+	result.key = key;
+	result.tex = nullptr;
+	result.w = result.h = 0;
+
+	surface surf = create();
+	if (surf) {
+		result.tex = SDL_CreateTextureFromSurface(get_renderer(), surf);
+		result.w = surf->w;
+		result.h = surf->h;
+	}
+	return result;
+}
+
+void ttrack::draw_overlay(SDL_Renderer* renderer, const toverlay& overlay, int x, int y) const
+{
+	if (overlay.tex.get()) {
+		const SDL_Rect dst = ::create_rect(x, y, overlay.w, overlay.h);
+		SDL_RenderCopy(renderer, overlay.tex.get(), NULL, &dst);
+	}
+}
+
 void ttrack::timer_handler()
 {
 	if (did_draw_ && background_tex_) {
@@ -148,6 +176,7 @@ void ttrack::clear_texture()
 	if (background_tex_.get()) {
 		background_tex_ = nullptr;
 	}
+	overlays_.clear();
 }
 
 const std::string& ttrack::get_control_type() const
@@ -39,6 +39,21 @@ public:
 		ttrack& widget_;
 	};
 
+	// overlay layer drawn by did_draw, i.e. text, icon.
+	// it is rasterized and uploaded only when key changes, later draws only copy texture.
+	struct toverlay
+	{
+		toverlay()
+			: w(0)
+			, h(0)
+		{}
+
+		std::string key;
+		texture tex;
+		int w;
+		int h;
+	};
+
 	ttrack();
 	~ttrack();
 
@@ -63,6 +78,17 @@ public:
 	SDL_Rect get_draw_rect() const;
 	texture& background_texture() { return background_tex_; }
 
+	/**
+	 * Get overlay of this layer, create it when required.
+	 *
+	 * @param layer               Index of layer, caller define it.
+	 * @param key                 Anything that result surface depend on, for text,
+	 *                            translated string and size. Changed key causes rebuild.
+	 * @param create              Generate surface of this layer.
+	 */
+	const toverlay& overlay(int layer, const std::string& key, const boost::function<surface ()>& create);
+	void draw_overlay(SDL_Renderer* renderer, const toverlay& overlay, int x, int y) const;
+
 	void set_require_capture(bool val) { require_capture_ = val; }
 	void set_timer_interval(int interval);
 
@@ -100,6 +126,7 @@ private:
 	texture background_tex_;
 	bool require_capture_;
 	int timer_interval_;
+	std::map<int, toverlay> overlays_;
 
 	boost::function<void (ttrack&, const SDL_Rect&, const bool)> did_draw_;
 
@@ -75,8 +75,10 @@ void ttree_view::remove_node(ttree_view_node* node)
 
 	VALIDATE(it != node->parent_node_->children_.end(), null_str);
 
+	ttree_view_node* parent = node->parent_node_;
 	delete(*it);
-	node->parent_node_->children_.erase(it);
+	parent->children_.erase(it);
+	parent->invalidate_best_size();
 
 	if (get_size() == tpoint(0, 0)) {
 		return;
@@ -161,6 +161,7 @@ ttree_view_node& ttree_view_node::add_child(
 			, tree_view()
 			, data
 			, branch));
+	(*itor)->invalidate_best_size();
 
 	if (is_folded() || is_root_node()) {
 		return **itor;
@@ -219,6 +220,9 @@ void ttree_view_node::fold()
 {
 	if (!empty() && icon_ && !icon_->get_value()) {
 		icon_->set_value(true);
+		// children leave hit area even if nothing is placed.
+		geometry_version ++;
+		invalidate_best_size();
 		if (is_child2(*tree_view().selected_item_)) {
 			tree_view().set_select_item(this);
 		}
@@ -229,6 +233,8 @@ void ttree_view_node::unfold()
 {
 	if (!empty() && icon_ && icon_->get_value()) {
 		icon_->set_value(false);
+		geometry_version ++;
+		invalidate_best_size();
 	}
 }
 
@@ -286,6 +292,7 @@ void ttree_view_node::clear()
 		delete *it;
 	}
 	children_.clear();
+	invalidate_best_size();
 
 	if (height_reduction == 0) {
 		return;
@@ -313,6 +320,20 @@ twidget* ttree_view_node::find_at(const tpoint& coordinate, const bool must_be_a
 	return NULL;
 }
 
+void ttree_view_node::collect_hit_widgets(std::vector<thit_widget>& widgets)
+{
+	if (parent_node_) {
+		panel_->collect_hit_widgets(widgets);
+	}
+	if (is_folded()) {
+		return;
+	}
+	for (std::vector<ttree_view_node*>::const_iterator it = children_.begin(); it != children_.end(); ++ it) {
+		ttree_view_node& node = **it;
+		node.collect_hit_widgets(widgets);
+	}
+}
+
 twidget* ttree_view_node::find(const std::string& id, const bool must_be_active)
 {
 	twidget* result = parent_node_? panel_->find(id, must_be_active): NULL;
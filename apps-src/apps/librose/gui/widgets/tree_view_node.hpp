@@ -119,6 +119,7 @@ public:
 
 	/** Inherited from twidget.*/
 	twidget* find_at(const tpoint& coordinate, const bool must_be_active);
+	void collect_hit_widgets(std::vector<thit_widget>& widgets) override;
 
 	/** Inherited from twidget.*/
 	twidget* find(const std::string& id, const bool must_be_active);
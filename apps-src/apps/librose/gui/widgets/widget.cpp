@@ -41,10 +41,13 @@ bool twidget::is_tpl_widget_id(const std::string& id)
 int twidget::hdpi_scale = 1;
 const int twidget::max_effectable_point = 540; // 1920x1080
 bool twidget::current_landscape = true;
+unsigned twidget::geometry_version = 0;
 
 const twidget* twidget::fire_event = nullptr;
 twidget* twidget::link_group_owner = nullptr;
 bool twidget::clear_restrict_width_cell_size = false;
+bool twidget::best_size_cache_enabled = false;
+unsigned twidget::best_size_generation = 0;
 
 bool twidget::landscape_from_orientation(torientation orientation, bool def)
 {
@@ -88,6 +91,7 @@ twidget::twidget()
 	, fix_rect_(null_rect)
 	, cookie_(NULL)
 	, layout_size_(tpoint(0,0))
+	, best_size_cached_(false)
 	, linked_group_()
 	, drag_(drag_none)
 	, float_widget_(false)
@@ -98,6 +102,8 @@ twidget::twidget()
 
 twidget::~twidget()
 {
+	geometry_version ++;
+
 	twidget* p = parent();
 	while (p) {
 		fire2(event::NOTIFY_REMOVAL, *p);
@@ -130,7 +136,13 @@ void twidget::set_id(const std::string& id)
 void twidget::layout_init(bool linked_group_only)
 {
 	if (!linked_group_only) {
-		layout_size_ = tpoint(0,0);
+		if (layout_size_ != tpoint(0, 0)) {
+			// linked group will set it again, until then parent's size is different.
+			if (parent_) {
+				parent_->invalidate_best_size();
+			}
+			layout_size_ = tpoint(0,0);
+		}
 		if (!linked_group_.empty()) {
 			link_group_owner->add_linked_widget(linked_group_, *this, linked_group_only);
 		}
@@ -176,6 +188,7 @@ void twidget::place(const tpoint& origin, const tpoint& size)
 		w_ = fix_rect_.w;
 		h_ = fix_rect_.h;
 	}
+	geometry_version ++;
 
 	set_dirty();
 }
@@ -190,6 +203,7 @@ void twidget::set_width(const int width)
 	}
 
 	w_ = width;
+	geometry_version ++;
 	set_dirty();
 }
 
@@ -200,6 +214,7 @@ void twidget::set_size(const tpoint& size)
 
 	w_ = size.x;
 	h_ = size.y;
+	geometry_version ++;
 
 	set_dirty();
 }
@@ -209,6 +224,13 @@ twidget* twidget::find_at(const tpoint& coordinate, const bool must_be_active)
 	return is_at(coordinate, must_be_active) ? this : NULL;
 }
 
+void twidget::collect_hit_widgets(std::vector<thit_widget>& widgets)
+{
+	if (visible_ == VISIBLE) {
+		widgets.push_back(thit_widget(this, NULL));
+	}
+}
+
 SDL_Rect twidget::get_dirty_rect() const
 {
 	return drawing_action_ == DRAWN
@@ -220,6 +242,7 @@ void twidget::move(const int x_offset, const int y_offset)
 {
 	x_ += x_offset;
 	y_ += y_offset;
+	geometry_version ++;
 }
 
 twindow* twidget::get_window()
@@ -281,9 +304,24 @@ void twidget::populate_dirty_list(twindow& caller, std::vector<twidget*>& call_s
 
 void twidget::set_layout_size(const tpoint& size) 
 {
+	if (size != layout_size_ && parent_) {
+		parent_->invalidate_best_size();
+	}
 	layout_size_ = size; 
 }
 
+void twidget::invalidate_best_size()
+{
+	twidget* widget = this;
+	while (widget) {
+		widget->best_size_cached_ = false;
+		if (!is_null_rect(widget->fix_rect_)) {
+			break;
+		}
+		widget = widget->parent_;
+	}
+}
+
 void twidget::set_visible(const tvisible visible)
 {
 	if (visible == visible_) {
@@ -293,6 +331,11 @@ void twidget::set_visible(const tvisible visible)
 	// Switching to or from invisible should invalidate the layout.
 	const bool need_resize = visible_ == INVISIBLE || visible == INVISIBLE;
 	visible_ = visible;
+	geometry_version ++;
+
+	if (need_resize) {
+		invalidate_best_size();
+	}
 
 	if (need_resize) {
 		twindow *window = get_window();
@@ -318,6 +361,7 @@ void twidget::set_origin(const tpoint& origin)
 
 	x_ = origin.x;
 	y_ = origin.y;
+	geometry_version ++;
 
 	redraw_ = true;
 }
@@ -113,6 +113,27 @@ public:
 	};
 	static bool clear_restrict_width_cell_size;
 
+	class tbest_size_cache_lock
+	{
+	public:
+		explicit tbest_size_cache_lock(bool enable = true)
+			: original_(best_size_cache_enabled)
+		{
+			best_size_cache_enabled = enable;
+		}
+		~tbest_size_cache_lock()
+		{
+			best_size_cache_enabled = original_;
+		}
+
+	private:
+		bool original_;
+	};
+	// during twindow::layout, grid reuse best size calculated by previous calculate_best_size.
+	static bool best_size_cache_enabled;
+	// cache calculated in other generation is stale. bumped when screen size and like change.
+	static unsigned best_size_generation;
+
 	static bool is_tpl_widget_id(const std::string& id);
 	
 	enum torientation {auto_orientation, landscape_orientation, portrait_orientation};
@@ -124,6 +145,10 @@ public:
 	static int hdpi_scale;
 	static const int max_effectable_point;
 
+	// increased when any widget is placed, moved, shown/hidden or destroyed.
+	// twindow's hit-test index is valid only when it is unchanged.
+	static unsigned geometry_version;
+
 	enum tdrag_direction { drag_none, drag_left = 0x1, drag_right = 0x2, drag_up = 0x4, drag_down = 0x8, drag_track = 0x10};
 	enum tmouse_event {mouse_down, mouse_leave, mouse_motion};
 
@@ -299,6 +324,35 @@ public:
 	virtual twidget* find_at(const tpoint& coordinate,
 			const bool must_be_active);
 
+	/**
+	 * Item of collect_hit_widgets, find_at returns first when second is_at coordinate.
+	 * When second is NULL, first->find_at decides, this is how leaves and
+	 * containers that the index doesn't model keep their own find_at rule.
+	 * When clipped, coordinate must be in clip too, ex: content of scroll container,
+	 * rows scrolled out of viewport keep their real rect.
+	 */
+	struct thit_widget {
+		thit_widget(twidget* first, const twidget* second)
+			: first(first)
+			, second(second)
+			, clipped(false)
+			, clip()
+		{}
+
+		twidget* first;
+		const twidget* second;
+		bool clipped;
+		SDL_Rect clip;
+	};
+
+	/**
+	 * Collects the widgets that find_at can return, in the order find_at tests them.
+	 *
+	 * twindow builds its hit-test index from it, so every class that overrides
+	 * find_at must override this too.
+	 */
+	virtual void collect_hit_widgets(std::vector<thit_widget>& widgets);
+
 	/**
 	 * Gets a widget with the wanted id.
 	 *
@@ -571,6 +625,12 @@ public:
 	void set_layout_size(const tpoint& size);
 	const tpoint& layout_size() const { return layout_size_; }
 
+	/**
+	 * Marks cached best size of this widget and it's ancestors as stale.
+	 * ancestor with fix_rect has stable size, propagation stops at it.
+	 */
+	void invalidate_best_size();
+
 	void set_drag(unsigned drag) { drag_ = drag; };
 	unsigned drag() const { return drag_; }
 
@@ -669,6 +729,9 @@ protected:
 	 */
 	tpoint layout_size_;
 
+	/** Whether best size cached by container is valid, see tbest_size_cache_lock. */
+	mutable bool best_size_cached_;
+
 	bool restrict_width_;
 
 	bool terminal_;
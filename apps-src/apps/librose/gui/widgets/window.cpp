@@ -192,6 +192,7 @@ twindow::twindow(CVideo& video,
 	, escape_disabled_(false)
 	, linked_size_()
 	, dirty_list_()
+	, best_size_inputs_()
 	, scene_(scene)
 	, orientation_(orientation)
 	, original_landscape_(current_landscape)
@@ -784,12 +785,97 @@ twidget* twindow::float_widget_find(const std::string& id, const bool must_be_ac
 	return result;
 }
 
+static const int hit_cell_size = 64;
+
+twindow::thit_index::thit_index()
+	: widgets_()
+	, cells_()
+	, rect_(empty_rect)
+	, cols_(0)
+	, rows_(0)
+	, version_(0)
+	, built_(false)
+{
+}
+
+void twindow::thit_index::build(twindow& window)
+{
+	widgets_.clear();
+	cells_.clear();
+
+	window.tpanel::collect_hit_widgets(widgets_);
+
+	rect_ = window.get_rect();
+	cols_ = (rect_.w + hit_cell_size - 1) / hit_cell_size;
+	rows_ = (rect_.h + hit_cell_size - 1) / hit_cell_size;
+	cells_.resize(cols_ * rows_);
+
+	int at = 0;
+	for (std::vector<thit_widget>::const_iterator it = widgets_.begin(); it != widgets_.end(); ++ it, at ++) {
+		SDL_Rect rect = (it->second? it->second: it->first)->get_rect();
+		if (it->clipped && !SDL_IntersectRect(&rect, &it->clip, &rect)) {
+			continue;
+		}
+		if (!SDL_IntersectRect(&rect, &rect_, &rect)) {
+			continue;
+		}
+		const int col_end = (rect.x + rect.w - 1 - rect_.x) / hit_cell_size;
+		const int row_end = (rect.y + rect.h - 1 - rect_.y) / hit_cell_size;
+		for (int row = (rect.y - rect_.y) / hit_cell_size; row <= row_end; row ++) {
+			for (int col = (rect.x - rect_.x) / hit_cell_size; col <= col_end; col ++) {
+				cells_[row * cols_ + col].push_back(at);
+			}
+		}
+	}
+	built_ = true;
+}
+
+bool twindow::thit_index::find_at(twindow& window, const tpoint& coordinate, const bool must_be_active, twidget*& result)
+{
+	if (version_ != twidget::geometry_version) {
+		// geometry is changing, wait it stable.
+		version_ = twidget::geometry_version;
+		built_ = false;
+		return false;
+	}
+	if (!built_) {
+		build(window);
+	}
+
+	if (!point_in_rect(coordinate.x, coordinate.y, rect_)) {
+		return false;
+	}
+	const std::vector<int>& cell = cells_[(coordinate.y - rect_.y) / hit_cell_size * cols_ + (coordinate.x - rect_.x) / hit_cell_size];
+
+	result = nullptr;
+	for (std::vector<int>::const_iterator it = cell.begin(); it != cell.end(); ++ it) {
+		const thit_widget& item = widgets_[*it];
+		if (item.clipped && !point_in_rect(coordinate.x, coordinate.y, item.clip)) {
+			continue;
+		}
+		if (!item.second) {
+			// ex: tcontrol::find_at requires get_active() when must_be_active.
+			result = item.first->find_at(coordinate, must_be_active);
+			if (result) {
+				break;
+			}
+		} else if (item.second->is_at(coordinate, must_be_active)) {
+			result = item.first;
+			break;
+		}
+	}
+	return true;
+}
+
 twidget* twindow::find_at(const tpoint& coordinate, const bool must_be_active)
 { 
 	twidget* result = float_widget_find_at(coordinate, must_be_active);
 	if (result) {
 		return result;
 	}
+	if (hit_index_.find_at(*this, coordinate, must_be_active, result)) {
+		return result;
+	}
 	return tpanel::find_at(coordinate, must_be_active); 
 }
 
@@ -933,6 +1019,21 @@ void twindow::layout()
 	variables_.add("volatile_height", variant(maximum_height / twidget::hdpi_scale));
 
 	/***** Layout. *****/
+	// these affect best size of every widget, ex: text width is limited by screen_width, formula use variables.
+	std::vector<int> best_size_inputs;
+	best_size_inputs.push_back(settings::screen_width);
+	best_size_inputs.push_back(settings::screen_height);
+	best_size_inputs.push_back(settings::keyboard_height);
+	best_size_inputs.push_back(twidget::hdpi_scale);
+	best_size_inputs.push_back(maximum_width);
+	best_size_inputs.push_back(maximum_height);
+	if (best_size_inputs != best_size_inputs_) {
+		best_size_inputs_ = best_size_inputs;
+		best_size_generation ++;
+	}
+
+	// from here to place, grids reuse best size unless it is invalidated by child.
+	tbest_size_cache_lock best_size_lock;
 	layout_init(false);
 
 	/***** Get the best location for the window *****/
@@ -1069,6 +1170,9 @@ void twindow::impl_draw_children(texture& frame_buffer, int x_offset, int y_offs
 
 void twindow::layout_linked_widgets()
 {
+	// layout_size of members is reset, don't cache size that calculated during it.
+	tbest_size_cache_lock best_size_lock(false);
+
 	// evaluate the group sizes
 	std::map<twidget*, tpoint> cache;
 	typedef std::pair<const std::string, tlinked_size> hack;
@@ -653,6 +653,39 @@ private:
 	std::vector<std::unique_ptr<tfloat_widget> > float_widgets_;
 	int tooltip_at_;
 
+	/**
+	 * Spatial index of widgets that find_at can return.
+	 *
+	 * The window is divided into uniform cells, every cell lists the hit
+	 * widgets overlapping it, in tree order. Index is built lazily, and only
+	 * after twidget::geometry_version stays unchanged between two queries, so
+	 * scrolling or animating windows keep to walk the tree.
+	 */
+	class thit_index
+	{
+	public:
+		thit_index();
+
+		// return false if index is unusable now, caller should walk the tree.
+		bool find_at(twindow& window, const tpoint& coordinate, const bool must_be_active, twidget*& result);
+
+	private:
+		void build(twindow& window);
+
+	private:
+		std::vector<thit_widget> widgets_;
+		std::vector<std::vector<int> > cells_;
+		SDL_Rect rect_;
+		int cols_;
+		int rows_;
+		unsigned version_;
+		bool built_;
+	};
+	thit_index hit_index_;
+
+	// screen size and like that best sizes are calculated with.
+	std::vector<int> best_size_inputs_;
+
 	bool scene_;
 
 	boost::function<void (twindow&, const int)> did_edit_click_;
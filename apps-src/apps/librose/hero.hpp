@@ -90,6 +90,7 @@ bool u16_get_experience_i12(uint16_t* field, uint16_t inc_xp);
 // 256 + 64 + 704 = 1024
 #define HEROS_MAX_HEROS			8192
 #define HEROS_BYTES_PER_HERO	240
+#define HEROS_CHECKSUM_KEY		"heros_checksum"
 #define HEROS_FILE_PREFIX_BYTES	16
 
 #define HEROS_INVALID_NUMBER	0xffff
@@ -798,11 +799,44 @@ public:
 	void reset_to_unstage();
 	void change_language();
 
+	// secondary indexes. they are rebuilt lazily on first query after map changed.
+	// side_/city_/status_/feature_ of hero in map must be modified by set_xxx, or call invalidate_index().
+	enum {index_side, index_city, index_status, index_feature, index_count};
+	const std::vector<hero*>& query(int index, int key) const;
+	const std::vector<hero*>& heros_of_side(int side) const { return query(index_side, side); }
+	const std::vector<hero*>& heros_of_city(int city) const { return query(index_city, city); }
+	const std::vector<hero*>& heros_of_status(int status) const { return query(index_status, status); }
+	const std::vector<hero*>& heros_of_feature(int feature) const { return query(index_feature, feature); }
+	void invalidate_index() { index_dirty_ = true; }
+
+	void set_side(hero& h, int side) { h.side_ = side; index_dirty_ = true; }
+	void set_city(hero& h, int city) { h.city_ = city; index_dirty_ = true; }
+	void set_status(hero& h, int status) { h.status_ = status; index_dirty_ = true; }
+	void set_feature(hero& h, int feature) { h.feature_ = feature; index_dirty_ = true; }
+
+	// records that failed check_valid() during last load.
+	const std::vector<std::string>& load_errors() const { return load_errors_; }
+
+private:
+	hero* alloc_hero();
+	void free_hero(hero* h);
+	void decode_records(const uint8_t* mem, uint32_t data_size, bool validate);
+	void rebuild_index() const;
+
 private:
 	size_t map_size_;
 
 	hero** map_;
 	uint16_t map_vsize_;
+
+	// contiguous storage of map_size_ heros, map_ point into it.
+	hero* arena_;
+	size_t arena_vsize_;
+
+	mutable bool index_dirty_;
+	mutable std::map<int, std::vector<hero*> > indexes_[index_count];
+
+	std::vector<std::string> load_errors_;
 };
 
 //
@@ -1009,7 +1043,7 @@ public:
 	int from_fp(hero_map& heros, uint8_t* mem);
 
 	void redirect_hero_map(hero_map& heros);
-	void remove_unstage_member();
+	void remove_unstage_member(const hero_map& heros);
 
 protected:
 	hero* leader_;
@@ -1084,7 +1118,7 @@ extern std::map<int, tgroup> gs;
 void insert(tgroup& g);
 tgroup& get(int leader);
 void redirect_hero_map(hero_map& heros);
-void remove_unstage_member();
+void remove_unstage_member(const hero_map& heros);
 
 void from_fp(hero_map& heros, posix_file_t fp, int len);
 size_t size();
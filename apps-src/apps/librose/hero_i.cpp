@@ -6,6 +6,10 @@
 #include "formula_string_utils.hpp"
 #include "rose_config.hpp"
 #include "integrate.hpp"
+#include "preferences.hpp"
+#include "util.hpp"
+
+#include <new>
 
 hero hero_invalid = hero(HEROS_INVALID_NUMBER);
 
@@ -1490,7 +1494,10 @@ size_t hero_map::map_size_from_dat = 0;
 hero_map::hero_map(const std::string& path) :
 	map_size_(0),
 	map_(NULL),
-	map_vsize_(0)
+	map_vsize_(0),
+	arena_(NULL),
+	arena_vsize_(0),
+	index_dirty_(true)
 {
 	if (!path.empty()) {
 		set_path(path);
@@ -1525,16 +1532,75 @@ void hero_map::realloc_hero_map(const size_t size)
 	map_size_ = size;
 	map_ = (hero**)malloc(size * sizeof(hero*));
 	map_vsize_ = 0;
+	// only raw memory, hero is constructed in-place by alloc_hero's caller.
+	arena_ = (hero*)malloc(size * sizeof(hero));
+	arena_vsize_ = 0;
+	index_dirty_ = true;
 }
 
 void hero_map::clear_map()
 {
 	for (size_t i = 0; i != map_vsize_; ++i) {
-		delete(map_[i]);
+		free_hero(map_[i]);
 	}
 	free(map_);
 	map_ = NULL;
 	map_vsize_ = 0;
+	if (arena_) {
+		free(arena_);
+		arena_ = NULL;
+	}
+	arena_vsize_ = 0;
+	index_dirty_ = true;
+	for (int n = 0; n < index_count; n ++) {
+		indexes_[n].clear();
+	}
+}
+
+hero* hero_map::alloc_hero()
+{
+	// slots of erased heros aren't reused, when arena is exhausted, fall back to heap.
+	if (arena_vsize_ < map_size_) {
+		return arena_ + arena_vsize_ ++;
+	}
+	return (hero*)malloc(sizeof(hero));
+}
+
+void hero_map::free_hero(hero* h)
+{
+	h->~hero();
+	if (h < arena_ || h >= arena_ + map_size_) {
+		free(h);
+	}
+}
+
+void hero_map::rebuild_index() const
+{
+	for (int n = 0; n < index_count; n ++) {
+		indexes_[n].clear();
+	}
+	for (uint16_t idx = 0; idx < map_vsize_; idx ++) {
+		hero* h = map_[idx];
+		indexes_[index_side][h->side_].push_back(h);
+		indexes_[index_city][h->city_].push_back(h);
+		indexes_[index_status][h->status_].push_back(h);
+		indexes_[index_feature][h->feature_].push_back(h);
+	}
+	index_dirty_ = false;
+}
+
+const std::vector<hero*>& hero_map::query(int index, int key) const
+{
+	VALIDATE(index >= 0 && index < index_count, null_str);
+	if (index_dirty_) {
+		rebuild_index();
+	}
+	const std::map<int, std::vector<hero*> >& indexes = indexes_[index];
+	std::map<int, std::vector<hero*> >::const_iterator it = indexes.find(key);
+	if (it == indexes.end()) {
+		return empty_vector_hero_ptr;
+	}
+	return it->second;
 }
 
 hero_map::iterator hero_map::begin() 
@@ -1561,9 +1627,11 @@ hero_map::const_iterator hero_map::end() const
 
 void hero_map::add(const hero& h)
 {
-	hero* p = new hero(h);
+	VALIDATE(map_vsize_ < map_size_, null_str);
+	hero* p = new (alloc_hero()) hero(h);
 	p->number_ = map_vsize_;
 	map_[map_vsize_ ++] = p;
+	index_dirty_ = true;
 }
 /*
 hero& hero_map::operator[](const uint16_t num)
@@ -1588,7 +1656,8 @@ void hero_map::erase(const uint16_t number)
 	if (number >= map_vsize_) {
 		return;
 	}
-	delete map_[number];
+	free_hero(map_[number]);
+	index_dirty_ = true;
 	if (number != (map_vsize_ - 1)) {
 		memcpy(&(map_[number]), &(map_[number + 1]), (map_vsize_ - number - 1) * sizeof(hero*));
 	}
@@ -1599,10 +1668,132 @@ void hero_map::erase(const uint16_t number)
 	}
 }
 
+namespace {
+
+struct tdecode_chunk
+{
+	tdecode_chunk(hero* _arena, const uint8_t* _mem, int _first, int _count, bool _validate)
+		: arena(_arena)
+		, mem(_mem)
+		, first(_first)
+		, count(_count)
+		, validate(_validate)
+		, invalid()
+	{}
+
+	hero* arena;
+	const uint8_t* mem;
+	int first;
+	int count;
+	bool validate;
+	// record index whose check_valid() failed.
+	std::vector<int> invalid;
+};
+
+// decode/validate phase. every chunk touchs only its own arena slots, so chunks can run concurrently.
+int SDLCALL decode_chunk(void* param)
+{
+	tdecode_chunk& chunk = *static_cast<tdecode_chunk*>(param);
+	const int last = chunk.first + chunk.count;
+	for (int at = chunk.first; at < last; at ++) {
+		hero* h = new (chunk.arena + at) hero(chunk.mem + at * HEROS_BYTES_PER_HERO);
+		if (chunk.validate && h->valid() && !h->check_valid()) {
+			chunk.invalid.push_back(at);
+		}
+	}
+	return 0;
+}
+
+uint32_t records_checksum(const uint8_t* mem, uint32_t size)
+{
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+	for (uint32_t at = 0; at < size; at ++) {
+		hash = (hash ^ mem[at]) * 16777619u;
+	}
+	return hash;
+}
+
+}
+
+#define HEROS_RECORDS_PER_CHUNK		1024
+
+void hero_map::decode_records(const uint8_t* mem, uint32_t data_size, bool validate)
+{
+	load_errors_.clear();
+
+	// realloc map memory in hero_map
+	realloc_hero_map(HEROS_MAX_HEROS);
+	int records = data_size / HEROS_BYTES_PER_HERO;
+	if (records > (int)map_size_) {
+		records = map_size_;
+	}
+	if (!records) {
+		return;
+	}
+
+	uint32_t checksum = 0;
+	if (validate && hero_check_valid) {
+		// records that passed validation before needn't do it again.
+		checksum = records_checksum(mem, records * HEROS_BYTES_PER_HERO);
+		if (preferences::get(HEROS_CHECKSUM_KEY) == str_cast(checksum)) {
+			validate = false;
+		}
+	} else {
+		validate = false;
+	}
+
+	std::vector<tdecode_chunk> chunks;
+	for (int first = 0; first < records; first += HEROS_RECORDS_PER_CHUNK) {
+		const int count = std::min(HEROS_RECORDS_PER_CHUNK, records - first);
+		chunks.push_back(tdecode_chunk(arena_, mem, first, count, validate));
+	}
+	const int max_threads = std::max(1, SDL_GetCPUCount());
+	std::vector<SDL_Thread*> threads;
+	for (int n = 1; n < (int)chunks.size(); n ++) {
+		SDL_Thread* thread = (int)threads.size() + 1 < max_threads? SDL_CreateThread(decode_chunk, "decode_heros", &chunks[n]): NULL;
+		if (thread) {
+			threads.push_back(thread);
+		} else {
+			decode_chunk(&chunks[n]);
+		}
+	}
+	decode_chunk(&chunks[0]);
+	for (std::vector<SDL_Thread*>::const_iterator it = threads.begin(); it != threads.end(); ++ it) {
+		SDL_WaitThread(*it, NULL);
+	}
+	arena_vsize_ = records;
+
+	// commit phase, sequential to keep number_ consecutive.
+	for (int at = 0; at < records; at ++) {
+		hero& h = arena_[at];
+		if (!h.valid()) {
+			h.~hero();
+			continue;
+		}
+		h.number_ = map_vsize_;
+		map_[map_vsize_ ++] = &h;
+	}
+	index_dirty_ = true;
+
+	// error report
+	for (std::vector<tdecode_chunk>::const_iterator it = chunks.begin(); it != chunks.end(); ++ it) {
+		for (std::vector<int>::const_iterator it2 = it->invalid.begin(); it2 != it->invalid.end(); ++ it2) {
+			hero& h = arena_[*it2];
+			std::stringstream strstr;
+			strstr << h.name() << "'s set is invalid!";
+			load_errors_.push_back(strstr.str());
+		}
+	}
+	if (validate && load_errors_.empty()) {
+		preferences::set(HEROS_CHECKSUM_KEY, str_cast(checksum));
+	}
+}
+
 bool hero_map::map_from_file(const std::string& fname)
 {
 	posix_file_t fp = INVALID_FILE;
-	int64_t fsize, rdpos;
+	int64_t fsize;
 	uint8_t* fdata = NULL;
 	uint32_t data_size;
 	bool fok = false;
@@ -1622,22 +1813,16 @@ bool hero_map::map_from_file(const std::string& fname)
 	posix_fseek(fp, HEROS_FILE_PREFIX_BYTES);
 	data_size = posix_fread(fp, fdata, fsize - HEROS_FILE_PREFIX_BYTES);
 
-	rdpos = 0;
-	// realloc map memory in hero_map
-	realloc_hero_map(HEROS_MAX_HEROS);
-	while (rdpos + HEROS_BYTES_PER_HERO <= data_size) {
-		hero h(fdata + rdpos);
-
-		if (!h.check_valid()) {
-			std::stringstream strstr;
-			strstr << h.name() << "'s set is invalid!";
-			posix_print_mb(utf8_2_ansi(strstr.str().c_str()));
-		}
-		
-		if (h.valid()) {
-			add(h);
+	decode_records(fdata, data_size, true);
+	if (!load_errors_.empty()) {
+		std::stringstream strstr;
+		for (std::vector<std::string>::const_iterator it = load_errors_.begin(); it != load_errors_.end(); ++ it) {
+			if (it != load_errors_.begin()) {
+				strstr << "\n";
+			}
+			strstr << *it;
 		}
-		rdpos += HEROS_BYTES_PER_HERO;
+		posix_print_mb(utf8_2_ansi(strstr.str().c_str()));
 	}
 
 	fok = true;
@@ -1655,7 +1840,7 @@ exit:
 
 bool hero_map::map_from_file_fp(posix_file_t fp, uint32_t file_offset, uint32_t valid_bytes)
 {
-	int64_t fsize, rdpos;
+	int64_t fsize;
 	uint8_t* fdata = NULL;
 	bool fok = false;
 
@@ -1679,16 +1864,7 @@ bool hero_map::map_from_file_fp(posix_file_t fp, uint32_t file_offset, uint32_t
 		data_size = posix_fread(fp, fdata, fsize - file_offset - HEROS_FILE_PREFIX_BYTES);
 	}
 
-	rdpos = 0;
-	// realloc map memory in hero_map
-	realloc_hero_map(HEROS_MAX_HEROS);
-	while (rdpos + HEROS_BYTES_PER_HERO <= data_size) {
-		hero h(fdata + rdpos);
-		if (h.valid()) {
-			add(h);
-		}
-		rdpos += HEROS_BYTES_PER_HERO;
-	}
+	decode_records(fdata, data_size, false);
 
 	fok = true;
 exit:
@@ -1705,17 +1881,7 @@ bool hero_map::map_from_mem(const uint8_t* mem, int len)
 		return false;
 	}
 
-	int rdpos = HEROS_FILE_PREFIX_BYTES;
-	// realloc map memory in hero_map
-	realloc_hero_map(HEROS_MAX_HEROS);
-	while (rdpos + HEROS_BYTES_PER_HERO <= len) {
-		hero h(mem + rdpos);
-
-		if (h.valid()) {
-			add(h);
-		}
-		rdpos += HEROS_BYTES_PER_HERO;
-	}
+	decode_records(mem + HEROS_FILE_PREFIX_BYTES, len - HEROS_FILE_PREFIX_BYTES, false);
 
 	return true;
 }
@@ -1832,6 +1998,7 @@ void hero_map::reset_to_unstage()
 		// It mean next scenario will clear commercials.
 		h.official_ = HEROS_DEFAULT_OFFICIAL;
 	}
+	index_dirty_ = true;
 }
 
 void hero_map::change_language()
@@ -1956,10 +2123,10 @@ void redirect_hero_map(hero_map& heros)
 	}
 }
 
-void remove_unstage_member()
+void remove_unstage_member(const hero_map& heros)
 {
 	for (std::map<int, tgroup>::iterator it = gs.begin(); it != gs.end(); ++ it) {
-		it->second.remove_unstage_member();
+		it->second.remove_unstage_member(heros);
 	}
 }
 
@@ -2164,7 +2331,7 @@ void tgroup_::unstage_member(hero_map& heros, int number)
 	}
 	VALIDATE(it != members_.end(), "tgroup_::unstage_member, cannot find number!");
 
-	heros[number].status_ = hero_status_unstage;
+	heros.set_status(heros[number], hero_status_unstage);
 }
 
 void tgroup_::adjust_members_according_to_leader(hero_map& heros)
@@ -2179,11 +2346,17 @@ void tgroup_::adjust_members_according_to_leader(hero_map& heros)
 	}
 }
 
-void tgroup_::remove_unstage_member()
+void tgroup_::remove_unstage_member(const hero_map& heros)
 {
+	const std::vector<hero*>& unstages = heros.heros_of_status(hero_status_unstage);
+	if (unstages.empty()) {
+		return;
+	}
+	const std::set<const hero*> unstage_set(unstages.begin(), unstages.end());
+
 	for (std::vector<tmember>::iterator it = members_.begin(); it != members_.end(); ) {
 		const tmember& m = *it;
-		if (m.h->status_ == hero_status_unstage) {
+		if (unstage_set.count(m.h)) {
 			it = members_.erase(it);
 		} else {
 			++ it;
@@ -2191,7 +2364,7 @@ void tgroup_::remove_unstage_member()
 	}
 	for (std::vector<tmember>::iterator it = exiles_.begin(); it != exiles_.end(); ) {
 		const tmember& m = *it;
-		if (m.h->status_ == hero_status_unstage) {
+		if (unstage_set.count(m.h)) {
 			it = exiles_.erase(it);
 		} else {
 			++ it;
@@ -2254,7 +2427,7 @@ void tgroup_::unstage_exile(hero_map& heros, int number)
 	}
 	VALIDATE(it != exiles_.end(), "tgroup_::unstage_exile, cannot find number!");
 
-	heros[number].status_ = hero_status_unstage;
+	heros.set_status(heros[number], hero_status_unstage);
 }
 
 void tgroup_::set_map(const std::string& str)
@@ -317,10 +317,9 @@ image::bool_cache in_hex_info_;
 // cache storing if this is an empty hex
 image::bool_cache is_empty_hex_;
 
+// memo of file existence, it is valid while dir_index_generation() is unchanged.
 std::map<std::string, bool> image_existence_map;
-
-// directories where we already cached file existence
-std::set<std::string> precached_dirs;
+unsigned image_existence_generation = 0;
 
 static std::set<image::locator> locators;
 
@@ -417,7 +416,6 @@ void flush_cache(bool force)
 	mini_terrain_cache.clear();
 	mini_fogged_terrain_cache.clear();
 	image_existence_map.clear();
-	precached_dirs.clear();
 }
 
 bool locator::operator==(const locator& a) const 
@@ -1655,36 +1653,7 @@ bool exists(const image::locator& i_locator)
 	if (type != loc::FILE && type != loc::SUB_FILE)
 		return false;
 
-	// The insertion will fail if there is already an element in the cache
-	std::pair< std::map< std::string, bool >::iterator, bool >
-		it = image_existence_map.insert(std::make_pair(i_locator.get_filename(), false));
-	bool &cache = it.first->second;
-	if (it.second)
-		cache = !get_binary_file_location("images", i_locator.get_filename()).empty();
-	return cache;
-}
-
-static void precache_file_existence_internal(const std::string& dir, const std::string& subdir)
-{
-	const std::string checked_dir = dir + "/" + subdir;
-	if (precached_dirs.find(checked_dir) != precached_dirs.end())
-		return;
-	precached_dirs.insert(checked_dir);
-
-	std::vector<std::string> files_found;
-	std::vector<std::string> dirs_found;
-	get_files_in_dir(checked_dir, &files_found, &dirs_found,
-			FILE_NAME_ONLY, NO_FILTER, DONT_REORDER);
-
-	for(std::vector<std::string>::const_iterator f = files_found.begin();
-			f != files_found.end(); ++f) {
-		image_existence_map[subdir + *f] = true;
-	}
-
-	for(std::vector<std::string>::const_iterator d = dirs_found.begin();
-			d != dirs_found.end(); ++d) {
-		precache_file_existence_internal(dir, subdir + *d + "/");
-	}
+	return precached_file_exists(i_locator.get_filename());
 }
 
 void precache_file_existence(const std::string& subdir)
@@ -1694,18 +1663,24 @@ void precache_file_existence(const std::string& subdir)
 	for (std::vector<std::string>::const_iterator p = paths.begin();
 			 p != paths.end(); ++p) {
 
-		const std::string dir = *p + "/" + subdir;
-		precache_file_existence_internal(*p, subdir);
+		precache_dir_index(*p + subdir);
 	}
 }
 
 bool precached_file_exists(const std::string& file)
 {
-	std::map<std::string, bool>::const_iterator b =  image_existence_map.find(file);
-	if (b != image_existence_map.end())
-		return b->second;
-	else
-		return false;
+	const unsigned generation = dir_index_generation();
+	if (generation != image_existence_generation) {
+		image_existence_map.clear();
+		image_existence_generation = generation;
+	}
+	// The insertion will fail if there is already an element in the cache
+	std::pair<std::map<std::string, bool>::iterator, bool> it = image_existence_map.insert(std::make_pair(file, false));
+	if (it.second) {
+		// existence is answered by directory index.
+		it.first->second = !get_binary_file_location("images", file).empty();
+	}
+	return it.first->second;
 }
 
 } // end namespace image
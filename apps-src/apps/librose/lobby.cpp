@@ -32,6 +32,8 @@
 #include "gui/dialogs/transient_message.hpp"
 #include "hero.hpp"
 
+#include <zlib.h>
+
 int dbg_error_no = 0;
 
 tlobby* lobby = NULL;
@@ -490,29 +492,43 @@ treceiver& find_receiver(int id, bool channel, bool allow_create)
 	return ins.first->second;
 }
 
+// in this seconds, continuous messages of same sender are merged to one log.
+#define LOG_MERGE_THRESHOLD		5
+
+static int log_time_diff(time_t t1, time_t t2)
+{
+	return t1 > t2? t1 - t2: t2 - t1;
+}
+
 void add(int id, bool channel, const tlobby_user& sender, const std::string& msg)
 {
 	treceiver& receiver = find_receiver(id, channel, true);
 
 	time_t t = time(NULL);
-	if (!receiver.logs.empty()) {
+	if (receiver.has_open_log()) {
 		tlog& log = receiver.logs.back();
-		int diff = 0;
-		if (log.t > t) {
-			diff = log.t - t;
-		} else if (log.t < t) {
-			diff = t - log.t;
-		}
-		if (diff <= 5 && sender.nick == log.nick) {
+		if (log_time_diff(log.t, t) <= LOG_MERGE_THRESHOLD && sender.nick == log.nick) {
 			std::stringstream ss;
 			ss << log.msg << "\n" << msg;
 			log.msg = ss.str();
 			return;
 		}
+		receiver.seal();
 	}
 	receiver.insert_log(sender.uid, sender.nick, msg, t);
 }
 
+void flush(bool force)
+{
+	time_t t = time(NULL);
+	for (std::map<int, treceiver>::iterator it = receivers.begin(); it != receivers.end(); ++ it) {
+		treceiver& receiver = it->second;
+		if (receiver.has_open_log() && (force || log_time_diff(receiver.logs.back().t, t) > LOG_MERGE_THRESHOLD)) {
+			receiver.seal();
+		}
+	}
+}
+
 const std::string history_log = "history.log";
 const std::string temp_log = "__temp.log";
 #define LOGFILE_HEADER_SIZE		48
@@ -542,6 +558,566 @@ struct tlogfile_index {
 	char nick[LOGFILE_INDEX_SIZE - 28];
 };
 
+//
+// journal.log: append-only segment of this session, every sealed log is appended when it arrives.
+// when exit(or next start after crash), it is combined into history.log.
+//
+const std::string journal_log = "journal.log";
+#define JOURNAL_DATA_PREFIX_SIZE	24
+
+struct tjournal_data {
+	uint64_t t;
+	int receiver_size;
+	int nick_size;
+	int msg_size;
+	uint32_t channel;
+};
+
+// 0: journal hasn't been created.
+static int journal_size = 0;
+// journal is kept open during session, sealed log is appended to it.
+static posix_file_t journal_fp = INVALID_FILE;
+
+static std::string journal_file()
+{
+	return get_user_data_dir_utf8() + "/data/" + journal_log;
+}
+
+static void close_journal()
+{
+	if (journal_fp != INVALID_FILE) {
+		posix_fclose(journal_fp);
+		journal_fp = INVALID_FILE;
+	}
+}
+
+static bool create_journal()
+{
+	close_journal();
+	posix_fopen(journal_file().c_str(), GENERIC_WRITE, CREATE_ALWAYS, journal_fp);
+	if (journal_fp == INVALID_FILE) {
+		return false;
+	}
+
+	tlogfile_header header;
+	memset(&header, 0, sizeof(header));
+	header.fourcc = mmioFOURCC('J', 'N', 'L', '0');
+	if ((int)posix_fwrite(journal_fp, &header, sizeof(header)) != (int)sizeof(header)) {
+		close_journal();
+		return false;
+	}
+
+	journal_size = LOGFILE_HEADER_SIZE;
+	return true;
+}
+
+// journal_size isn't 0 but journal_fp is invalid when journal was closed by save_temp_logfile but kept.
+static bool open_journal()
+{
+	if (journal_fp != INVALID_FILE) {
+		return true;
+	}
+	if (!journal_size) {
+		return create_journal();
+	}
+	posix_fopen(journal_file().c_str(), GENERIC_WRITE, OPEN_EXISTING, journal_fp);
+	return journal_fp != INVALID_FILE;
+}
+
+static void log_from_journal(const char* data, tlog& log)
+{
+	tjournal_data prefix;
+	memcpy(&prefix, data, sizeof(prefix));
+	log.t = prefix.t;
+	log.nick.assign(data + JOURNAL_DATA_PREFIX_SIZE + prefix.receiver_size, prefix.nick_size);
+	log.msg.assign(data + JOURNAL_DATA_PREFIX_SIZE + prefix.receiver_size + prefix.nick_size, prefix.msg_size);
+}
+
+//
+// full-text search. inverted index of history.log is persisted to history_idx, combine_logfile updates it
+// when it rewrites history.log. journal is indexed in memory when every log is sealed.
+// word is run of letter/digit, CJK run is split to bigram, every CJK char is indexed as unigram too.
+//
+const std::string history_idx = "history.idx";
+#define SEARCH_INDEX_HEADER_SIZE	20
+
+struct tsearch_doc {
+	tsearch_doc(int receiver, bool journal, int offset, time_t t)
+		: receiver(receiver)
+		, journal(journal)
+		, offset(offset)
+		, t(t)
+	{}
+
+	int receiver;
+	bool journal;
+	// journal: offset in journal.log. history: nth log of this receiver in history.log.
+	int offset;
+	time_t t;
+};
+
+struct tsearch_index {
+	void clear();
+	int receiver_at(const std::string& receiver);
+	void add(const std::string& receiver, bool journal, int offset, time_t t, const std::set<std::string>& tokens);
+	// skips: receiver ==> count of logs skipped from front of it. doc of receiver not in skips is dropped.
+	void shift_history(const std::map<std::string, int>& skips);
+	void append(const tsearch_index& that);
+
+	// stamp is size of history.log when it is saved.
+	bool load(const std::string& file, int stamp);
+	bool save(const std::string& file, int stamp) const;
+
+	std::vector<std::string> receivers;
+	std::vector<tsearch_doc> docs;
+	// token ==> doc id, every vector is ascending.
+	std::map<std::string, std::vector<int> > postings;
+};
+
+static tsearch_index search_index;
+
+static bool is_cjk_char(wchar_t ch)
+{
+	return (ch >= 0x3040 && ch <= 0x30ff) || (ch >= 0x3400 && ch <= 0x4dbf) || (ch >= 0x4e00 && ch <= 0x9fff)
+		|| (ch >= 0xac00 && ch <= 0xd7af) || (ch >= 0xf900 && ch <= 0xfaff);
+}
+
+static bool is_word_char(wchar_t ch)
+{
+	if (ch < 0x80) {
+		return isalnum(ch) != 0;
+	}
+	// latin-1 letters, greek, cyrillic etc.
+	return ch >= 0xc0 && ch < 0x2000 && ch != 0xd7 && ch != 0xf7;
+}
+
+// unigram: insert every char of CJK run, so one-char query can hit any position. used when indexing.
+static void tokenize(const std::string& text, bool unigram, std::set<std::string>& tokens)
+{
+	const wide_string wtext = utils::string_to_wstring(text);
+	const int size = wtext.size();
+	wide_string word;
+
+	for (int at = 0; at < size; ) {
+		wchar_t ch = wtext[at];
+		if (is_cjk_char(ch)) {
+			int end = at + 1;
+			while (end < size && is_cjk_char(wtext[end])) {
+				end ++;
+			}
+			if (end - at == 1 || unigram) {
+				for (int at2 = at; at2 < end; at2 ++) {
+					tokens.insert(utils::wchar_to_string(wtext[at2]));
+				}
+			}
+			for (int at2 = at; at2 + 1 < end; at2 ++) {
+				word.assign(wtext.begin() + at2, wtext.begin() + at2 + 2);
+				tokens.insert(utils::wstring_to_string(word));
+			}
+			at = end;
+
+		} else if (is_word_char(ch)) {
+			word.clear();
+			while (at < size && is_word_char(wtext[at])) {
+				ch = wtext[at ++];
+				word.push_back(ch < 0x80? tolower(ch): ch);
+			}
+			tokens.insert(utils::wstring_to_string(word));
+
+		} else {
+			at ++;
+		}
+	}
+}
+
+void tsearch_index::clear()
+{
+	receivers.clear();
+	docs.clear();
+	postings.clear();
+}
+
+int tsearch_index::receiver_at(const std::string& receiver)
+{
+	std::vector<std::string>::iterator it = std::find(receivers.begin(), receivers.end(), receiver);
+	if (it != receivers.end()) {
+		return std::distance(receivers.begin(), it);
+	}
+	receivers.push_back(receiver);
+	return receivers.size() - 1;
+}
+
+void tsearch_index::add(const std::string& receiver, bool journal, int offset, time_t t, const std::set<std::string>& tokens)
+{
+	const int doc = docs.size();
+	docs.push_back(tsearch_doc(receiver_at(receiver), journal, offset, t));
+	for (std::set<std::string>::const_iterator it = tokens.begin(); it != tokens.end(); ++ it) {
+		postings[*it].push_back(doc);
+	}
+}
+
+void tsearch_index::shift_history(const std::map<std::string, int>& skips)
+{
+	std::vector<int> remap(docs.size(), -1);
+	std::vector<tsearch_doc> docs2;
+	for (int n = 0; n < (int)docs.size(); n ++) {
+		tsearch_doc doc = docs[n];
+		std::map<std::string, int>::const_iterator it = skips.find(receivers[doc.receiver]);
+		if (doc.journal || it == skips.end() || doc.offset < it->second) {
+			continue;
+		}
+		doc.offset -= it->second;
+		remap[n] = docs2.size();
+		docs2.push_back(doc);
+	}
+	docs.swap(docs2);
+
+	for (std::map<std::string, std::vector<int> >::iterator it = postings.begin(); it != postings.end(); ) {
+		std::vector<int>& ids = it->second;
+		int size = 0;
+		for (std::vector<int>::const_iterator it2 = ids.begin(); it2 != ids.end(); ++ it2) {
+			if (remap[*it2] != -1) {
+				ids[size ++] = remap[*it2];
+			}
+		}
+		ids.resize(size);
+		if (ids.empty()) {
+			postings.erase(it ++);
+		} else {
+			++ it;
+		}
+	}
+}
+
+void tsearch_index::append(const tsearch_index& that)
+{
+	const int base = docs.size();
+	for (std::vector<tsearch_doc>::const_iterator it = that.docs.begin(); it != that.docs.end(); ++ it) {
+		tsearch_doc doc = *it;
+		doc.receiver = receiver_at(that.receivers[doc.receiver]);
+		docs.push_back(doc);
+	}
+	for (std::map<std::string, std::vector<int> >::const_iterator it = that.postings.begin(); it != that.postings.end(); ++ it) {
+		std::vector<int>& ids = postings[it->first];
+		for (std::vector<int>::const_iterator it2 = it->second.begin(); it2 != it->second.end(); ++ it2) {
+			ids.push_back(base + *it2);
+		}
+	}
+}
+
+static bool read_index_int(const char* data, int size, int& pos, int& value)
+{
+	if (pos + (int)sizeof(int) > size) {
+		return false;
+	}
+	memcpy(&value, data + pos, sizeof(int));
+	pos += sizeof(int);
+	return true;
+}
+
+static bool read_index_string(const char* data, int size, int& pos, std::string& value)
+{
+	int len;
+	if (!read_index_int(data, size, pos, len) || len < 0 || pos + len > size) {
+		return false;
+	}
+	value.assign(data + pos, len);
+	pos += len;
+	return true;
+}
+
+static void write_index_int(std::string& data, int value)
+{
+	data.append((const char*)&value, sizeof(int));
+}
+
+static void write_index_string(std::string& data, const std::string& value)
+{
+	write_index_int(data, value.size());
+	data.append(value);
+}
+
+bool tsearch_index::load(const std::string& file, int stamp)
+{
+	clear();
+
+	tfile lock(file, GENERIC_READ, OPEN_EXISTING);
+	const int fsize = lock.read_2_data();
+	if (fsize < SEARCH_INDEX_HEADER_SIZE) {
+		return false;
+	}
+	const char* data = lock.data;
+	uint32_t fourcc;
+	memcpy(&fourcc, data, sizeof(fourcc));
+	int pos = sizeof(fourcc);
+	int stamp2, receivers_size, docs_size, postings_size;
+	read_index_int(data, fsize, pos, stamp2);
+	read_index_int(data, fsize, pos, receivers_size);
+	read_index_int(data, fsize, pos, docs_size);
+	read_index_int(data, fsize, pos, postings_size);
+	if (fourcc != mmioFOURCC('I', 'D', 'X', '0') || stamp2 != stamp || receivers_size < 0 || docs_size < 0 || postings_size < 0) {
+		return false;
+	}
+
+	bool ok = true;
+	std::string str;
+	for (int n = 0; ok && n < receivers_size; n ++) {
+		ok = read_index_string(data, fsize, pos, str);
+		receivers.push_back(str);
+	}
+
+	int receiver, offset;
+	int64_t t;
+	for (int n = 0; ok && n < docs_size; n ++) {
+		ok = read_index_int(data, fsize, pos, receiver) && read_index_int(data, fsize, pos, offset) && pos + (int)sizeof(t) <= fsize;
+		ok = ok && receiver >= 0 && receiver < receivers_size && offset >= 0;
+		if (ok) {
+			memcpy(&t, data + pos, sizeof(t));
+			pos += sizeof(t);
+			docs.push_back(tsearch_doc(receiver, false, offset, t));
+		}
+	}
+
+	int count, doc;
+	for (int n = 0; ok && n < postings_size; n ++) {
+		ok = read_index_string(data, fsize, pos, str) && read_index_int(data, fsize, pos, count) && count > 0;
+		std::vector<int>& ids = postings[str];
+		for (int at = 0; ok && at < count; at ++) {
+			ok = read_index_int(data, fsize, pos, doc) && doc >= 0 && doc < docs_size && (ids.empty() || doc > ids.back());
+			ids.push_back(doc);
+		}
+	}
+
+	if (!ok || pos != fsize) {
+		clear();
+		return false;
+	}
+	return true;
+}
+
+bool tsearch_index::save(const std::string& file, int stamp) const
+{
+	std::string data;
+	uint32_t fourcc = mmioFOURCC('I', 'D', 'X', '0');
+	data.append((const char*)&fourcc, sizeof(fourcc));
+	write_index_int(data, stamp);
+	write_index_int(data, receivers.size());
+	write_index_int(data, docs.size());
+	write_index_int(data, postings.size());
+
+	for (std::vector<std::string>::const_iterator it = receivers.begin(); it != receivers.end(); ++ it) {
+		write_index_string(data, *it);
+	}
+	for (std::vector<tsearch_doc>::const_iterator it = docs.begin(); it != docs.end(); ++ it) {
+		const tsearch_doc& doc = *it;
+		VALIDATE(!doc.journal, "journal doc must not be saved!");
+		write_index_int(data, doc.receiver);
+		write_index_int(data, doc.offset);
+		const int64_t t = doc.t;
+		data.append((const char*)&t, sizeof(t));
+	}
+	for (std::map<std::string, std::vector<int> >::const_iterator it = postings.begin(); it != postings.end(); ++ it) {
+		write_index_string(data, it->first);
+		write_index_int(data, it->second.size());
+		data.append((const char*)&it->second[0], it->second.size() * sizeof(int));
+	}
+
+	tfile lock(file, GENERIC_WRITE, CREATE_ALWAYS);
+	if (!lock.valid()) {
+		return false;
+	}
+	if (posix_fwrite(lock.fp, data.c_str(), data.size()) != data.size()) {
+		lock.close();
+		SDL_DeleteFiles(file.c_str());
+		return false;
+	}
+	return true;
+}
+
+// index logs in [data, data + size), nth of first log is nth. index is NULL: only count.
+// return count of logs.
+static int index_logs(tsearch_index* index, const std::string& receiver, int nth, const char* data, int size)
+{
+	std::string msg;
+	std::set<std::string> tokens;
+	tlogfile_data prefix;
+	int pos = 0, count = 0;
+	while (pos + LOGFILE_DATA_PREFIX_SIZE <= size) {
+		const char* ptr = data + pos;
+		memcpy(&prefix, ptr, sizeof(prefix));
+		if (prefix.nick_size < 0 || prefix.msg_size < 0 || pos + LOGFILE_DATA_PREFIX_SIZE + prefix.nick_size + prefix.msg_size > size) {
+			break;
+		}
+		if (index) {
+			msg.assign(ptr + LOGFILE_DATA_PREFIX_SIZE + prefix.nick_size, prefix.msg_size);
+			tokens.clear();
+			tokenize(msg, true, tokens);
+			if (!tokens.empty()) {
+				index->add(receiver, false, nth + count, prefix.t, tokens);
+			}
+		}
+		pos += LOGFILE_DATA_PREFIX_SIZE + prefix.nick_size + prefix.msg_size;
+		count ++;
+	}
+	return count;
+}
+
+static std::string search_index_file()
+{
+	return get_user_data_dir_utf8() + "/data/" + history_idx;
+}
+
+// history_idx is missing or doesn't match history.log, rebuild it. only happen after crash or upgrade.
+static void index_history_logfile(int fsize)
+{
+	std::string file = get_user_data_dir_utf8() + "/data/" + history_log;
+
+	tfile lock(file, GENERIC_READ, OPEN_EXISTING);
+	if (lock.read_2_data() != fsize) {
+		return;
+	}
+
+	for (std::set<thistory_log>::const_iterator it = history_logs.begin(); it != history_logs.end(); ++ it) {
+		const thistory_log& user = *it;
+		if (user.offset + user.size > fsize) {
+			continue;
+		}
+		index_logs(&search_index, user.nick, 0, lock.data + user.offset, user.size);
+	}
+	search_index.save(search_index_file(), fsize);
+}
+
+static bool compare_hit_newer(const tsearch_hit& a, const tsearch_hit& b)
+{
+	return a.t > b.t;
+}
+
+void search(const std::string& text, std::vector<tsearch_hit>& hits, size_t max_hits)
+{
+	hits.clear();
+
+	std::set<std::string> tokens;
+	tokenize(text, false, tokens);
+	if (tokens.empty()) {
+		return;
+	}
+
+	const std::map<std::string, std::vector<int> >& postings = search_index.postings;
+	std::vector<int> docs, result;
+	for (std::set<std::string>::const_iterator it = tokens.begin(); it != tokens.end(); ++ it) {
+		std::map<std::string, std::vector<int> >::const_iterator it2 = postings.find(*it);
+		if (it2 == postings.end()) {
+			return;
+		}
+		const std::vector<int>& that = it2->second;
+		if (it == tokens.begin()) {
+			docs = that;
+		} else {
+			result.clear();
+			std::set_intersection(docs.begin(), docs.end(), that.begin(), that.end(), std::back_inserter(result));
+			docs.swap(result);
+		}
+		if (docs.empty()) {
+			return;
+		}
+	}
+
+	for (std::vector<int>::const_iterator it = docs.begin(); it != docs.end(); ++ it) {
+		const tsearch_doc& doc = search_index.docs[*it];
+		hits.push_back(tsearch_hit(search_index.receivers[doc.receiver], doc.journal, doc.offset, doc.t));
+	}
+	std::stable_sort(hits.begin(), hits.end(), compare_hit_newer);
+	if (hits.size() > max_hits) {
+		hits.erase(hits.begin() + max_hits, hits.end());
+	}
+}
+
+void treceiver::seal()
+{
+	if (!has_open_log()) {
+		return;
+	}
+	const tlog& log = logs.back();
+
+	tjournal_data data;
+	data.t = log.t;
+	data.receiver_size = nick.size();
+	data.nick_size = log.nick.size();
+	data.msg_size = log.msg.size();
+	data.channel = channel? 1: 0;
+	const int size = JOURNAL_DATA_PREFIX_SIZE + data.receiver_size + data.nick_size + data.msg_size;
+
+	// -1: fail to write journal, this log must keep in memory.
+	int offset = -1;
+	if (open_journal()) {
+		std::vector<char> buf(size);
+		char* ptr = &buf[0];
+		memcpy(ptr, &data, sizeof(data));
+		ptr += JOURNAL_DATA_PREFIX_SIZE;
+		memcpy(ptr, nick.c_str(), data.receiver_size);
+		ptr += data.receiver_size;
+		memcpy(ptr, log.nick.c_str(), data.nick_size);
+		ptr += data.nick_size;
+		memcpy(ptr, log.msg.c_str(), data.msg_size);
+
+		posix_fseek(journal_fp, journal_size);
+		if ((int)posix_fwrite(journal_fp, &buf[0], size) == size) {
+			offset = journal_size;
+			journal_size += size;
+		}
+	}
+	indexs.push_back(tlog_index(log.t, offset, size));
+	if (offset != -1) {
+		std::set<std::string> tokens;
+		tokenize(log.msg, true, tokens);
+		if (!tokens.empty()) {
+			search_index.add(nick, true, offset, log.t, tokens);
+		}
+	}
+
+	if ((int)logs.size() > max_memory_logs) {
+		// evict to half, avoid erasing front of vector every log.
+		const int max_erase = logs.size() - max_memory_logs / 2;
+		int erase = 0;
+		while (erase < max_erase && indexs[evicted + erase].offset != -1) {
+			erase ++;
+		}
+		logs.erase(logs.begin(), logs.begin() + erase);
+		evicted += erase;
+	}
+}
+
+void treceiver::read_logs(int start, int end, std::vector<tlog>& result) const
+{
+	VALIDATE(start >= 0 && start <= end && end < size(), null_str);
+
+	if (start < evicted) {
+		const int last = posix_min(end, evicted - 1);
+		// logs of other receivers maybe between them, but read whole span by one read.
+		const int from = indexs[start].offset;
+		const int span = indexs[last].offset + indexs[last].size - from;
+
+		// read by session handle, data written by it maybe not reach file yet.
+		std::vector<char> buf(span);
+		bool ok = open_journal();
+		if (ok) {
+			posix_fseek(journal_fp, from);
+			ok = (int)posix_fread(journal_fp, &buf[0], span) == span;
+		}
+		for (int at = start; at <= last; at ++) {
+			const tlog_index& index = indexs[at];
+			result.push_back(tlog(tlobby_user::npos, null_str, null_str, index.t));
+			if (ok) {
+				log_from_journal(&buf[0] + index.offset - from, result.back());
+			}
+		}
+	}
+
+	for (int at = posix_max(start, evicted); at <= end; at ++) {
+		result.push_back(logs[at - evicted]);
+	}
+}
+
 std::set<thistory_log> history_logs;
 
 bool valid_logfile(tfile& lock, int* index_offset, int* index_size)
@@ -639,6 +1215,16 @@ void restore_from_logfile()
 {
 	int index_offset, index_size;
 
+	// journal is left by last crash, combine it into history.log at first.
+	save_temp_logfile();
+	combine_logfile();
+	if (!journal_size) {
+		// journal_size isn't 0 when journal is kept for failing to write temp_log.
+		create_journal();
+	}
+	// logs in journal have been moved to history.log, docs in memory are stale.
+	search_index.clear();
+
 	std::string file = get_user_data_dir_utf8() + "/data/" + history_log;
 
 	tfile lock(file, GENERIC_READ, OPEN_EXISTING);
@@ -651,6 +1237,11 @@ void restore_from_logfile()
 	posix_fread(lock.fp, lock.data, index_size);
 
 	indexs_from_mem(lock.data, index_size, history_logs);
+	lock.close();
+
+	if (!search_index.load(search_index_file(), index_offset + index_size)) {
+		index_history_logfile(index_offset + index_size);
+	}
 }
 
 void user_from_logfile(const thistory_log& user, std::vector<tlog>& logs)
@@ -685,99 +1276,206 @@ void user_from_logfile(const thistory_log& user, std::vector<tlog>& logs)
 	} while (pos < user.size);
 }
 
+void offsets_from_logfile(const thistory_log& user, std::vector<int>& offsets)
+{
+	offsets.clear();
+	if (!user.size) {
+		return;
+	}
+	std::string file = get_user_data_dir_utf8() + "/data/" + history_log;
+
+	tfile lock(file, GENERIC_READ, OPEN_EXISTING);
+	if (!valid_logfile(lock, NULL, NULL)) {
+		return;
+	}
+
+	lock.resize_data(user.size);
+	posix_fseek(lock.fp, user.offset);
+	posix_fread(lock.fp, lock.data, user.size);
+
+	tlogfile_data data;
+	int pos = 0;
+	do {
+		memcpy(&data, lock.data + pos, sizeof(data));
+		if (data.nick_size < 0 || data.nick_size >= user.size) {
+			return;
+		}
+		if (data.msg_size < 0 || data.msg_size >= user.size) {
+			return;
+		}
+		offsets.push_back(user.offset + pos);
+		pos += LOGFILE_DATA_PREFIX_SIZE + data.nick_size + data.msg_size;
+		
+	} while (pos < user.size);
+}
+
+void logs_from_logfile(const thistory_log& user, const std::vector<int>& offsets, int start, int end, std::vector<tlog>& logs)
+{
+	VALIDATE(start >= 0 && start <= end && end < (int)offsets.size(), null_str);
+
+	std::string file = get_user_data_dir_utf8() + "/data/" + history_log;
+	tfile lock(file, GENERIC_READ, OPEN_EXISTING);
+
+	// logs of one user are continuous in history.log.
+	const int from = offsets[start];
+	const int span = (end + 1 < (int)offsets.size()? offsets[end + 1]: user.offset + user.size) - from;
+	bool ok = lock.valid();
+	if (ok) {
+		lock.resize_data(span);
+		posix_fseek(lock.fp, from);
+		ok = (int)posix_fread(lock.fp, lock.data, span) == span;
+	}
+
+	tlogfile_data data;
+	for (int at = start; at <= end; at ++) {
+		logs.push_back(tlog(tlobby_user::npos, null_str, null_str, 0));
+		if (!ok) {
+			continue;
+		}
+		tlog& log = logs.back();
+		const char* ptr = lock.data + offsets[at] - from;
+		memcpy(&data, ptr, sizeof(data));
+		log.t = data.t;
+		log.nick.assign(ptr + LOGFILE_DATA_PREFIX_SIZE, data.nick_size);
+		log.msg.assign(ptr + LOGFILE_DATA_PREFIX_SIZE + data.nick_size, data.msg_size);
+	}
+}
+
+static bool write_temp_logfile(const std::string& file, const std::vector<char>& journal, const std::map<std::string, std::vector<int> >& receivers2);
+
+// journal to temp_log, group logs by receiver.
 void save_temp_logfile()
 {
-	// if no chat, do nothing;
-	int has_log_receivers = 0;
-	for (std::map<int, treceiver>::const_iterator it = receivers.begin(); it != receivers.end(); ++ it) {
-		const treceiver& receiver = it->second;
-		if (!receiver.logs.empty()) {
-			has_log_receivers ++;
+	flush(true);
+	// below read/delete journal by name.
+	close_journal();
+
+	std::vector<char> journal;
+	{
+		tfile lock(journal_file(), GENERIC_READ, OPEN_EXISTING);
+		const int fsize = lock.read_2_data();
+		if (fsize <= LOGFILE_HEADER_SIZE || ((tlogfile_header*)lock.data)->fourcc != mmioFOURCC('J', 'N', 'L', '0')) {
+			return;
+		}
+		journal.assign(lock.data, lock.data + fsize);
+	}
+	const int fsize = journal.size();
+
+	// receiver nick ==> offsets in journal.
+	std::map<std::string, std::vector<int> > receivers2;
+	tjournal_data data;
+	int pos = LOGFILE_HEADER_SIZE;
+	while (pos + JOURNAL_DATA_PREFIX_SIZE <= fsize) {
+		memcpy(&data, &journal[pos], sizeof(data));
+		if (data.receiver_size <= 0 || data.nick_size < 0 || data.msg_size <= 0) {
+			break;
+		}
+		const int size = JOURNAL_DATA_PREFIX_SIZE + data.receiver_size + data.nick_size + data.msg_size;
+		if (pos + size > fsize) {
+			// tail is broken by crash.
+			break;
+		}
+		if (data.receiver_size < (int)sizeof(((tlogfile_index*)NULL)->nick)) {
+			receivers2[std::string(&journal[pos + JOURNAL_DATA_PREFIX_SIZE], data.receiver_size)].push_back(pos);
 		}
+		pos += size;
 	}
-	if (!has_log_receivers) {
+
+	if (receivers2.empty()) {
+		SDL_DeleteFiles(journal_file().c_str());
+		journal_size = 0;
 		return;
 	}
 
-	std::string file = get_user_data_dir_utf8() + "/data/" + temp_log;
+	// journal is the only copy of this session, delete it after temp_log is written.
+	const std::string file = get_user_data_dir_utf8() + "/data/" + temp_log;
+	if (!write_temp_logfile(file, journal, receivers2)) {
+		SDL_DeleteFiles(file.c_str());
+		// keep journal, new logs append after its valid part.
+		journal_size = pos;
+		return;
+	}
+	SDL_DeleteFiles(journal_file().c_str());
+	journal_size = 0;
+}
 
+static bool write_temp_logfile(const std::string& file, const std::vector<char>& journal, const std::map<std::string, std::vector<int> >& receivers2)
+{
 	tfile lock(file, GENERIC_WRITE, CREATE_ALWAYS);
 	if (!lock.valid()) {
-		return;
+		return false;
 	}
+	bool fok = true;
+	tjournal_data data;
 
 	tlogfile_header header;
-	tlogfile_data data;
-
 	memset(&header, 0, sizeof(header));
 	header.fourcc = mmioFOURCC('L', 'O', 'G', '0');
 	
-	int index_size = has_log_receivers * LOGFILE_INDEX_SIZE;
+	const int index_size = receivers2.size() * LOGFILE_INDEX_SIZE;
 	header.index_size = index_size;
 	// last will update it. here is move file pointer.
-	posix_fwrite(lock.fp, &header, sizeof(header));
-	
-	lock.resize_data(128 * 1024);
-	VALIDATE(lock.data_size > index_size, "more users!");
+	fok &= (int)posix_fwrite(lock.fp, &header, sizeof(header)) == (int)sizeof(header);
+
+	lock.resize_data(index_size);
 	memset(lock.data, 0, index_size);
 
-	int data_size = 0;
+	tlogfile_data data2;
+	int data_size;
 	char* ptr;
 	int n = 0;
 	int fpos = LOGFILE_HEADER_SIZE;
 
+	for (std::map<std::string, std::vector<int> >::const_iterator it = receivers2.begin(); it != receivers2.end(); ++ it, n ++) {
+		const std::vector<int>& offsets = it->second;
 
-	for (std::map<int, treceiver>::const_iterator it = receivers.begin(); it != receivers.end(); ++ it) {
-		const treceiver& receiver = it->second;
-		if (receiver.logs.empty()) {
-			continue;
+		data_size = 0;
+		for (std::vector<int>::const_iterator it2 = offsets.begin(); it2 != offsets.end(); ++ it2) {
+			memcpy(&data, &journal[*it2], sizeof(data));
+			data_size += LOGFILE_DATA_PREFIX_SIZE + data.nick_size + data.msg_size;
 		}
 
+		lock.resize_data(index_size + data_size, index_size);
 		tlogfile_index* index = (tlogfile_index*)(lock.data + n * LOGFILE_INDEX_SIZE);
-		index->from = receiver.logs.front().t;
-		index->to = receiver.logs.back().t;
 		index->offset = fpos;
-		memcpy(index->nick, receiver.nick.c_str(), receiver.nick.size());
-		data_size = 0;
-		for (std::vector<tlog>::const_iterator it2 = receiver.logs.begin(); it2 != receiver.logs.end(); ++ it2) {
-			const tlog& log = *it2;
-			data_size += 8 + 4 + 4 + log.nick.size() + log.msg.size();
-		}
 		index->size = data_size;
 		index->flag = 0;
+		memcpy(index->nick, it->first.c_str(), it->first.size());
 
-		lock.resize_data(index_size + data_size);
 		ptr = lock.data + index_size;
-		for (std::vector<tlog>::const_iterator it2 = receiver.logs.begin(); it2 != receiver.logs.end(); ++ it2) {
-			const tlog& log = *it2;
-			data.t = log.t;
-			data.nick_size = log.nick.size();
-			data.msg_size = log.msg.size();
-			
-			memcpy(ptr, &data, sizeof(data));
-			ptr += sizeof(data);
-			memcpy(ptr, log.nick.c_str(), data.nick_size);
-			ptr += data.nick_size;
-			memcpy(ptr, log.msg.c_str(), data.msg_size);
-			ptr += data.msg_size;
-		}
-		posix_fwrite(lock.fp, lock.data + index_size, data_size);
+		for (std::vector<int>::const_iterator it2 = offsets.begin(); it2 != offsets.end(); ++ it2) {
+			const char* src = &journal[*it2];
+			memcpy(&data, src, sizeof(data));
+			if (it2 == offsets.begin()) {
+				index->from = data.t;
+			}
+			index->to = data.t;
+
+			data2.t = data.t;
+			data2.nick_size = data.nick_size;
+			data2.msg_size = data.msg_size;
+			memcpy(ptr, &data2, sizeof(data2));
+			ptr += sizeof(data2);
+			memcpy(ptr, src + JOURNAL_DATA_PREFIX_SIZE + data.receiver_size, data.nick_size + data.msg_size);
+			ptr += data.nick_size + data.msg_size;
+		}
+		fok &= (int)posix_fwrite(lock.fp, lock.data + index_size, data_size) == data_size;
 		fpos += data_size;
-		n ++;
 	}
 
 	// align 4
 	int fpos2 = (fpos + 3) & ~3;
 	if (fpos2 != fpos) {
-		posix_fwrite(lock.fp, lock.data + index_size, fpos2 - fpos);
+		fok &= (int)posix_fwrite(lock.fp, lock.data + index_size, fpos2 - fpos) == fpos2 - fpos;
 	}
 
 	// sequence wirte.
-	posix_fwrite(lock.fp, lock.data, index_size);
+	fok &= (int)posix_fwrite(lock.fp, lock.data, index_size) == index_size;
 
 	header.index_offset = fpos2;
 	posix_fseek(lock.fp, 0);
-	posix_fwrite(lock.fp, &header, sizeof(header));
+	fok &= (int)posix_fwrite(lock.fp, &header, sizeof(header)) == (int)sizeof(header);
+	return fok;
 }
 
 bool can_combine_logfile(const std::set<thistory_log>& temps, const std::set<thistory_log>& historys)
@@ -870,7 +1568,12 @@ void combine_logfile()
 	result.resize_data((history_logs2.size() + temp_logs.size()) * LOGFILE_INDEX_SIZE);
 	memset(result.data, 0, (history_logs2.size() + temp_logs.size()) * LOGFILE_INDEX_SIZE);
 
-	int skip_size;
+	// history_idx matches previous history.log, shift it by skipped logs. else rebuild from logs written.
+	tsearch_index search_idx, added;
+	std::map<std::string, int> skips;
+	const bool index_valid = search_idx.load(search_index_file(), history_index_offset + history_index_size);
+
+	int skip_size, nth;
 	time_t min_log_time = time(NULL) - log_days * 24 * 3600;
 	min_log_time -= min_log_time % (24 * 3600);
 	std::set<thistory_log>::iterator temp_it;
@@ -894,6 +1597,10 @@ void combine_logfile()
 		history.resize_data(history_log.size);
 		posix_fread(history.fp, history.data, history_log.size);
 		skip_size = skip_log(min_log_time, history.data, history_log.size);
+		if (index_valid) {
+			skips[history_log.nick] = index_logs(NULL, history_log.nick, 0, history.data, skip_size);
+		}
+		nth = index_logs(index_valid? NULL: &added, history_log.nick, 0, history.data + skip_size, history_log.size - skip_size);
 		if (skip_size < history_log.size) {
 			index->size = history_log.size - skip_size;
 			posix_fwrite(result.fp, history.data + skip_size, index->size);
@@ -910,6 +1617,7 @@ void combine_logfile()
 			posix_fread(temp.fp, temp.data, temp_log.size);
 			posix_fwrite(result.fp, temp.data, temp_log.size);
 			fpos += temp_log.size;
+			index_logs(&added, history_log.nick, nth, temp.data, temp_log.size);
 
 			// update to time.
 			index->to = temp_log.to;
@@ -936,6 +1644,7 @@ void combine_logfile()
 		temp.resize_data(temp_log.size);
 		posix_fread(temp.fp, temp.data, temp_log.size);
 		posix_fwrite(result.fp, temp.data, temp_log.size);
+		index_logs(&added, temp_log.nick, 0, temp.data, temp_log.size);
 
 		fpos += temp_log.size;
 	}
@@ -965,6 +1674,10 @@ void combine_logfile()
 	SDL_DeleteFiles(temp_file.c_str());
 	SDL_DeleteFiles(history_file.c_str());
 	SDL_RenameFile(result_file.c_str(), history_log.c_str());
+
+	search_idx.shift_history(skips);
+	search_idx.append(added);
+	search_idx.save(search_index_file(), fpos2 + n * LOGFILE_INDEX_SIZE);
 }
 
 }
@@ -975,6 +1688,7 @@ tlobby::tchat_sock::tchat_sock()
 	, pong_receiving_(false)
 	, last_task_time_(0)
 	, online_offline_received_(false)
+	, line_start_(0)
 {
 	tag_ = _("Chat");
 	task_threshold_ = noresponse_threshold_;
@@ -1060,6 +1774,7 @@ irc::ircnet tlobby::tchat_sock::generate_ircnet() const
 
 void tlobby::tchat_sock::mini_connectd()
 {
+	line_start_ = 0;
 	lobby->add_log(*this, "Connected success! Enter consult.");
 	serv_->p_login(serv_, serv_->network.nick.c_str(), serv_->network.real.c_str());
 }
@@ -1079,48 +1794,54 @@ void tlobby::tchat_sock::mini_read()
 	// since has receive data, i think this conenction is active.
 	pong_receiving_ = false;
 
-	const int chunk_size = 1024;
-	int ret_size = 0, data_pos = 0, segment_pos = 0, line_pos = 0;
+	const int min_recv_size = 4096;
+	int ret_size, scan_pos;
 
-	do {
-		if (raw_data_size_ < raw_data_vsize_ + chunk_size) {
-			resize_raw_data(raw_data_size_ + chunk_size);
+	while (true) {
+		if (raw_data_size_ - raw_data_vsize_ < min_recv_size) {
+			if (line_start_) {
+				// reclaim consumed head. only the partial line is moved.
+				if (raw_data_vsize_ > line_start_) {
+					memmove(raw_data_, raw_data_ + line_start_, raw_data_vsize_ - line_start_);
+				}
+				raw_data_vsize_ -= line_start_;
+				line_start_ = 0;
+			}
+			if (raw_data_size_ - raw_data_vsize_ < min_recv_size) {
+				resize_raw_data(posix_max(raw_data_size_ * 2, raw_data_vsize_ + min_recv_size));
+			}
 		}
-		ret_size = socket_->Recv(raw_data_ + raw_data_vsize_, chunk_size, nullptr);
+		ret_size = socket_->Recv(raw_data_ + raw_data_vsize_, raw_data_size_ - raw_data_vsize_, nullptr);
 		if (ret_size <= 0) {
 			break;
 		}
 
+		// only new received bytes require search.
+		scan_pos = raw_data_vsize_;
 		raw_data_vsize_ += ret_size;
 
-		while (data_pos < raw_data_vsize_) {
-			switch (raw_data_[data_pos]) {
-			case '\r':
+		while (true) {
+			char* eol = (char*)memchr(raw_data_ + scan_pos, '\n', raw_data_vsize_ - scan_pos);
+			if (!eol) {
 				break;
-
-			case '\n':
-				raw_data_[segment_pos + line_pos] = 0;
-				serv_->p_inline(serv_, raw_data_ + segment_pos, line_pos);
-				segment_pos = data_pos + 1; // 1 is this \n.
-				line_pos = 0;
-				break;
-
-			default:
-				line_pos ++;
 			}
-			data_pos ++;
-		}
+			char* line = raw_data_ + line_start_;
+			int len = eol - line;
+			if (len && line[len - 1] == '\r') {
+				len --;
+			}
+			// line is terminated in place, proto_irc parse it directly.
+			line[len] = '\0';
+			serv_->p_inline(serv_, line, len);
 
-	} while (ret_size == chunk_size || raw_data_vsize_ != segment_pos);
+			line_start_ = scan_pos = eol - raw_data_ + 1; // 1 is this \n.
+		}
+	}
 
-	if (!raw_data_vsize_ || raw_data_vsize_ == segment_pos) {
+	if (line_start_ == raw_data_vsize_) {
+		line_start_ = 0;
 		raw_data_vsize_ = 0;
-		return;
 	}
-
-	VALIDATE(raw_data_vsize_ > segment_pos, null_str);
-	memmove(raw_data_, raw_data_ + segment_pos, raw_data_vsize_ - segment_pos);
-	raw_data_vsize_ -= segment_pos;
 }
 
 void tlobby::tchat_sock::mini_close(int err)
@@ -1131,6 +1852,9 @@ void tlobby::tchat_sock::process()
 {
 	const Uint32 now = SDL_GetTicks();
 
+	// write logs that can not be merged to journal.
+	chat_logs::flush(false);
+
 	if (state_ == s_none) {
 		if (now <= next_create_time_) {
 			return;
@@ -1846,6 +2570,34 @@ void tlobby::tchat_sock::process_quit_bh(const std::string& nick)
 	}
 }
 
+// keep-alive timeout when server doesn't tell it by Keep-Alive header.
+static const Uint32 default_keep_alive_timeout = 15000;
+
+tlobby::thttp_sock::thttp_sock()
+	: tsock(tag_http)
+	, progress_(nullptr)
+	, response_size_(0)
+	, response_()
+	, parse_state_(parse_header)
+	, parse_offset_(0)
+	, header_scan_(0)
+	, header_size_(0)
+	, content_length_(0)
+	, body_received_(0)
+	, chunk_left_(0)
+	, encoding_(encoding_identity)
+	, inflate_(nullptr)
+	, raw_deflate_(false)
+	, keep_alive_(false)
+	, keep_alive_timeout_(default_keep_alive_timeout)
+	, last_response_ticks_(0)
+{}
+
+tlobby::thttp_sock::~thttp_sock()
+{
+	end_inflate();
+}
+
 void tlobby::thttp_sock::process()
 {
 	if (state_ == s_none) {
@@ -1882,9 +2634,24 @@ void tlobby::thttp_sock::reset_connect()
 	if (socket_.get() != nullptr) {
 		tsock::reset_connect();
 	}
+	// tsock::connect will reset raw_data_vsize_, offsets to raw_data_ are invalid.
+	parse_offset_ = 0;
+	header_scan_ = 0;
 	set_host(null_str, INVALID_PORT);
 }
 
+bool tlobby::thttp_sock::reusable() const
+{
+	if (state_ != s_ready || !keep_alive_) {
+		return false;
+	}
+	if (parse_state_ != parse_done && parse_state_ != parse_header) {
+		// in the middle of one response.
+		return false;
+	}
+	return SDL_GetTicks() - last_response_ticks_ < keep_alive_timeout_;
+}
+
 std::string tlobby::thttp_sock::form_request(const std::string& task, size_t content_length) const
 {
 	std::stringstream request;
@@ -1893,7 +2660,7 @@ std::string tlobby::thttp_sock::form_request(const std::string& task, size_t con
 
 	// request << "Accept: image/jpeg, application/x-ms-application, image/gif, application/xaml+xml, image/pjpeg, application/x-ms-xbap, application/vnd.ms-excel, application/vnd.ms-powerpoint, application/msword, */*\r\n";
 	// request << "Accept-Language: zh-CN\r\n";
-	// request << "Accept-Encoding: gzip, deflate\r\n";
+	request << "Accept-Encoding: gzip, deflate\r\n";
 	request << "Host: " << host_ << "\r\n";
 	request << "Connection: Keep-Alive\r\n";
 	request << "Content-Length: " << content_length << "\r\n";
@@ -1966,6 +2733,46 @@ int tlobby::thttp_sock::http_2_cfg(const char* http, const int size, config& cfg
 	return content_start;
 }
 
+const char* tlobby::thttp_sock::find_header_field(const char* http, const int size, const char* name, int& len)
+{
+	const int name_len = strlen(name);
+	const char* end = http + size;
+	const char* line = http;
+
+	while (line < end) {
+		const char* eol = (const char*)memchr(line, '\n', end - line);
+		if (!eol) {
+			eol = end;
+		}
+		if (eol - line > name_len && line[name_len] == ':' && !SDL_strncasecmp(line, name, name_len)) {
+			const char* value = line + name_len + 1;
+			const char* value_end = eol;
+			while (value < value_end && (*value == ' ' || *value == '\t')) {
+				value ++;
+			}
+			while (value_end > value && (value_end[-1] == '\r' || value_end[-1] == ' ' || value_end[-1] == '\t')) {
+				value_end --;
+			}
+			len = value_end - value;
+			return value;
+		}
+		line = eol + 1;
+	}
+	len = 0;
+	return nullptr;
+}
+
+static bool header_value_contains(const char* value, int len, const char* token)
+{
+	const int token_len = strlen(token);
+	for (int at = 0; at + token_len <= len; at ++) {
+		if (!SDL_strncasecmp(value + at, token, token_len)) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void tlobby::thttp_sock::mini_connectd()
 {
 	posix_print("tlobby::thttp_sock::mini_connected()------, state_: %i\n", state_);
@@ -1974,71 +2781,355 @@ void tlobby::thttp_sock::mini_connectd()
 		progress_->set_percent(gui2::tprogress_::finish_precent);
 	}
 	response_size_ = 0;
+	// raw_data_ is empty on new connection.
+	parse_offset_ = 0;
+	reset_response();
 	state_ = s_ready;
 }
 
-void tlobby::thttp_sock::mini_read()
+void tlobby::thttp_sock::end_inflate()
 {
-	VALIDATE(state_ == s_ready, null_str);
-	VALIDATE(!response_size_ || response_size_ <= raw_data_vsize_, null_str);
+	if (inflate_) {
+		inflateEnd(inflate_);
+		delete inflate_;
+		inflate_ = nullptr;
+	}
+}
 
-	const int chunk_size = 1024;
-	int total_size, ret_size;
+void tlobby::thttp_sock::reset_response()
+{
+	response_.clear();
+	parse_state_ = parse_header;
+	header_scan_ = parse_offset_;
+	header_size_ = 0;
+	keep_alive_timeout_ = default_keep_alive_timeout;
+	content_length_ = 0;
+	body_received_ = 0;
+	chunk_left_ = 0;
+	encoding_ = encoding_identity;
+	raw_deflate_ = false;
+	end_inflate();
+}
+
+bool tlobby::thttp_sock::parse_header_block()
+{
+	const char* data = raw_data_ + parse_offset_;
+	const int size = header_size_;
 
-	char* end_header = NULL;
-	std::string header;
+	// status line: HTTP/1.x code phrase
+	int status = 0;
+	bool http_10 = false;
+	if (size > 12 && !memcmp(data, "HTTP/1.", 7)) {
+		http_10 = data[7] == '0';
+		status = atoi(data + 9);
+	}
+	if (status < 100) {
+		return false;
+	}
 
-	if (response_size_ && raw_data_vsize_ >= response_size_) {
-		if (raw_data_vsize_ > response_size_) {
-			memmove(raw_data_, raw_data_ + response_size_, raw_data_vsize_ - response_size_);
+	int len;
+	const char* value = find_header_field(data, size, "Connection", len);
+	if (value) {
+		keep_alive_ = !header_value_contains(value, len, "close");
+	} else {
+		keep_alive_ = !http_10;
+	}
+	value = find_header_field(data, size, "Keep-Alive", len);
+	if (value) {
+		std::string str(value, len);
+		size_t pos = str.find("timeout=");
+		if (pos != std::string::npos) {
+			int timeout = atoi(str.c_str() + pos + 8);
+			if (timeout > 0) {
+				keep_alive_timeout_ = timeout * 1000;
+			}
 		}
-		raw_data_vsize_ -= response_size_;
-		response_size_ = 0;
 	}
 
-	while (!end_header) {
-		if (raw_data_size_ < raw_data_vsize_ + chunk_size) {
-			resize_raw_data(raw_data_size_ + chunk_size);
+	value = find_header_field(data, size, "Content-Encoding", len);
+	if (value) {
+		if (header_value_contains(value, len, "gzip")) {
+			encoding_ = encoding_gzip;
+		} else if (header_value_contains(value, len, "deflate")) {
+			encoding_ = encoding_deflate;
 		}
-		ret_size = socket_->Recv(raw_data_ + raw_data_vsize_, chunk_size, NULL);
-		if (ret_size <= 0) {
-			return;
+	}
+	if (encoding_ != encoding_identity) {
+		inflate_ = new z_stream;
+		memset(inflate_, 0, sizeof(z_stream));
+		// 32: auto detect gzip or zlib header.
+		if (inflateInit2(inflate_, MAX_WBITS + 32) != Z_OK) {
+			delete inflate_;
+			inflate_ = nullptr;
+			return false;
 		}
-		raw_data_vsize_ += ret_size;
-		end_header = strstr(raw_data_, "\r\n\r\n");
 	}
 
-	int content_length = 0;
-	char* start = strstr(raw_data_, "Content-Length:");
-	if (start && start < end_header) {
-		start += 15;
-		char* end = strstr(start, "\r\n");
-		if (end && end <= end_header) {
-			std::string str(start, end - start);
-			content_length = lexical_cast<int>(str);
+	response_.reserve(header_size_);
+	response_.insert(response_.end(), data, data + header_size_);
+
+	if (status < 200 || status == 204 || status == 304) {
+		content_length_ = 0;
+		parse_state_ = parse_done;
+		return true;
+	}
+
+	value = find_header_field(data, size, "Transfer-Encoding", len);
+	if (value && header_value_contains(value, len, "chunked")) {
+		parse_state_ = parse_chunk_size;
+		return true;
+	}
+
+	value = find_header_field(data, size, "Content-Length", len);
+	if (value) {
+		content_length_ = atoi(std::string(value, len).c_str());
+		if (content_length_ < 0) {
+			return false;
+		}
+		if (encoding_ == encoding_identity) {
+			response_.reserve(header_size_ + content_length_);
 		}
+	} else {
+		// no length, body ends when server close connection.
+		content_length_ = -1;
+		keep_alive_ = false;
 	}
-	
-	total_size = (end_header - raw_data_) + 4 + content_length;
-	resize_raw_data(total_size);
+	parse_state_ = content_length_? parse_body: parse_done;
+	return true;
+}
 
-	while (total_size > raw_data_vsize_) {
-		ret_size = socket_->Recv(raw_data_ + raw_data_vsize_, total_size - raw_data_vsize_, NULL);
-		if (ret_size <= 0) {
-			return;
+bool tlobby::thttp_sock::append_body(const char* data, int len)
+{
+	if (!inflate_) {
+		response_.insert(response_.end(), data, data + len);
+		return true;
+	}
+
+	const int min_out_size = 16 * 1024;
+	inflate_->next_in = (Bytef*)data;
+	inflate_->avail_in = len;
+	while (inflate_->avail_in) {
+		int vsize = response_.size();
+		if ((int)response_.capacity() - vsize < min_out_size) {
+			response_.reserve(posix_max(response_.capacity() * 2, (size_t)(vsize + min_out_size)));
+		}
+		response_.resize(response_.capacity());
+		inflate_->next_out = (Bytef*)&response_[vsize];
+		inflate_->avail_out = response_.size() - vsize;
+
+		int ret = inflate(inflate_, Z_NO_FLUSH);
+		response_.resize(response_.size() - inflate_->avail_out);
+
+		if (ret == Z_DATA_ERROR && encoding_ == encoding_deflate && !raw_deflate_ && !inflate_->total_out) {
+			// some servers send raw deflate data without zlib header.
+			raw_deflate_ = true;
+			inflateReset2(inflate_, -MAX_WBITS);
+			inflate_->next_in = (Bytef*)data;
+			inflate_->avail_in = len;
+			continue;
+		}
+		if (ret == Z_STREAM_END) {
+			break;
+		}
+		if (ret != Z_OK && ret != Z_BUF_ERROR) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static const char* find_crlf(const char* data, int size)
+{
+	const char* end = data + size;
+	while (data < end) {
+		const char* cr = (const char*)memchr(data, '\r', end - data);
+		if (!cr || cr + 1 >= end) {
+			return nullptr;
+		}
+		if (cr[1] == '\n') {
+			return cr;
+		}
+		data = cr + 1;
+	}
+	return nullptr;
+}
+
+// true: parse succeed, maybe not complete. false: invalid response.
+bool tlobby::thttp_sock::parse_response()
+{
+	while (parse_state_ != parse_done) {
+		const char* data = raw_data_ + parse_offset_;
+		const int size = raw_data_vsize_ - parse_offset_;
+
+		if (parse_state_ == parse_header) {
+			// only new received bytes require search. 3 to cross read boundary.
+			int from = posix_max(header_scan_ - 3, parse_offset_);
+			const char* end_header = nullptr;
+			while (from < raw_data_vsize_) {
+				const char* crlf = find_crlf(raw_data_ + from, raw_data_vsize_ - from);
+				if (!crlf) {
+					break;
+				}
+				if (crlf + 4 <= raw_data_ + raw_data_vsize_ && crlf[2] == '\r' && crlf[3] == '\n') {
+					end_header = crlf;
+					break;
+				}
+				from = crlf - raw_data_ + 2;
+			}
+			header_scan_ = raw_data_vsize_;
+			if (!end_header) {
+				return true;
+			}
+			header_size_ = end_header - data + 4;
+			if (!parse_header_block()) {
+				return false;
+			}
+			parse_offset_ += header_size_;
+
+		} else if (parse_state_ == parse_body) {
+			int len = size;
+			if (content_length_ >= 0 && len > content_length_ - body_received_) {
+				len = content_length_ - body_received_;
+			}
+			if (!len) {
+				return true;
+			}
+			if (!append_body(data, len)) {
+				return false;
+			}
+			parse_offset_ += len;
+			body_received_ += len;
+			if (body_received_ == content_length_) {
+				parse_state_ = parse_done;
+
+			} else if (progress_ && content_length_ > 0) {
+				progress_->set_percent(1LL * body_received_ * (gui2::tprogress_::finish_precent - 1) / content_length_);
+			}
+
+		} else if (parse_state_ == parse_chunk_size) {
+			const char* crlf = find_crlf(data, size);
+			if (!crlf) {
+				return true;
+			}
+			char* end = nullptr;
+			long chunk_size = strtol(data, &end, 16);
+			if (end == data || chunk_size < 0) {
+				return false;
+			}
+			chunk_left_ = chunk_size;
+			parse_offset_ += crlf - data + 2;
+			parse_state_ = chunk_left_? parse_chunk_data: parse_chunk_trailer;
+
+		} else if (parse_state_ == parse_chunk_data) {
+			int len = posix_min(size, chunk_left_);
+			if (!len) {
+				return true;
+			}
+			if (!append_body(data, len)) {
+				return false;
+			}
+			parse_offset_ += len;
+			body_received_ += len;
+			chunk_left_ -= len;
+			if (!chunk_left_) {
+				parse_state_ = parse_chunk_crlf;
+			}
+
+		} else if (parse_state_ == parse_chunk_crlf) {
+			if (size < 2) {
+				return true;
+			}
+			if (data[0] != '\r' || data[1] != '\n') {
+				return false;
+			}
+			parse_offset_ += 2;
+			parse_state_ = parse_chunk_size;
+
+		} else if (parse_state_ == parse_chunk_trailer) {
+			const char* crlf = find_crlf(data, size);
+			if (!crlf) {
+				return true;
+			}
+			parse_offset_ += crlf - data + 2;
+			if (crlf == data) {
+				parse_state_ = parse_done;
+			}
 		}
-		raw_data_vsize_ += ret_size;
 	}
+	return true;
+}
+
+void tlobby::thttp_sock::finish_response()
+{
+	end_inflate();
+	last_response_ticks_ = SDL_GetTicks();
+	response_size_ = response_.size();
 
 	if (progress_) {
 		progress_->set_percent(gui2::tprogress_::finish_precent);
 	}
-	// maybe total_size < raw_data_vsize_
-	response_size_ = total_size;
+}
+
+void tlobby::thttp_sock::mini_read()
+{
+	VALIDATE(state_ == s_ready, null_str);
+
+	const int min_recv_size = 4096;
+	int ret_size;
+
+	if (parse_state_ == parse_done) {
+		// previous response has been taken, receive next one.
+		response_size_ = 0;
+		reset_response();
+	}
+	if (parse_offset_) {
+		// only the unparsed tail is moved, it is less than one chunk header at most times.
+		if (raw_data_vsize_ > parse_offset_) {
+			memmove(raw_data_, raw_data_ + parse_offset_, raw_data_vsize_ - parse_offset_);
+		}
+		raw_data_vsize_ -= parse_offset_;
+		header_scan_ = posix_max(header_scan_ - parse_offset_, 0);
+		parse_offset_ = 0;
+	}
+
+	while (true) {
+		if (raw_data_size_ - raw_data_vsize_ < min_recv_size) {
+			// geometric grow, avoid quadratic copy on large response.
+			resize_raw_data(posix_max(raw_data_size_ * 2, raw_data_vsize_ + min_recv_size));
+		}
+		ret_size = socket_->Recv(raw_data_ + raw_data_vsize_, raw_data_size_ - raw_data_vsize_, NULL);
+		if (ret_size <= 0) {
+			break;
+		}
+		raw_data_vsize_ += ret_size;
+		if (!parse_response()) {
+			posix_print("thttp_sock::mini_read, invalid response\n");
+			keep_alive_ = false;
+			tsock::reset_connect();
+			parse_offset_ = 0;
+			header_scan_ = 0;
+			if (progress_) {
+				progress_->cancel_task();
+			}
+			return;
+		}
+		if (parse_state_ == parse_done) {
+			// maybe raw_data_vsize_ > parse_offset_, left for next response.
+			finish_response();
+			return;
+		}
+	}
 }
 
 void tlobby::thttp_sock::mini_close(int err)
 {
+	if (parse_state_ == parse_body && content_length_ == -1) {
+		// body delimited by connection close.
+		parse_state_ = parse_done;
+		finish_response();
+		return;
+	}
+	keep_alive_ = false;
 	if (progress_) {
 		progress_->cancel_task();
 	}
@@ -2076,6 +3167,13 @@ static std::string form_receive_from_title()
 
 bool tlobby::thttp_sock::network_connect_dialog(display& disp, bool quiet)
 {
+	if (state_ == s_ready) {
+		if (reusable()) {
+			// keep-alive connection, skip handshake.
+			return true;
+		}
+		tsock::reset_connect();
+	}
 	VALIDATE(state_ == s_none || state_ == s_created, null_str);
 
 	gui2::tnetwork_transmission dlg(form_connect_to_title(), "");
@@ -2442,6 +3540,11 @@ void tlobby::pump()
 			sock->process();
 		}
 	}
+
+	// all received data in this pump has been dispatched, handlers can update ui once.
+	for (size_t i1 = 0, i2 = handlers_.size(); i1 != i2 && i1 < handlers_.size(); ++ i1) {
+		handlers_[i1]->handle_pump();
+	}
 }
 
 void tlobby::broadcast_handle_status(int at, tsock::ttype type)
@@ -35,6 +35,7 @@ struct server;
 
 class display;
 class tlobby;
+struct z_stream_s;
 
 struct tnoresponse_msg
 {
@@ -226,10 +227,27 @@ struct tlog {
 	time_t t;
 };
 
+// one sealed log in journal.
+struct tlog_index {
+	tlog_index(time_t t, int offset, int size)
+		: t(t)
+		, offset(offset)
+		, size(size)
+	{}
+
+	time_t t;
+	int offset;
+	int size;
+};
+
 struct treceiver {
+	// memory cap of one conversation. older sealed logs are read from journal on demand.
+	static const int max_memory_logs = 200;
+
 	treceiver(int id = tlobby_channel::npos, bool channel = true)
 		: id(id)
 		, channel(channel)
+		, evicted(0)
 	{
 		if (id != tlobby_channel::npos) {
 			nick = channel? tlobby_channel::get_nick(id): tlobby_user::get_nick(id);
@@ -242,10 +260,21 @@ struct treceiver {
 		logs.push_back(tlog(uid, nick, msg, t));
 	}
 
+	int size() const { return evicted + (int)logs.size(); }
+	// last log maybe merged with next message, it isn't written to journal.
+	bool has_open_log() const { return size() > (int)indexs.size(); }
+	void seal();
+	// [start, end] are index in this session.
+	void read_logs(int start, int end, std::vector<tlog>& result) const;
+
 	int id;
 	bool channel;
 	std::string nick;
+	// logs[0] is the evicted'th log of this session.
 	std::vector<tlog> logs;
+	// time index of sealed logs, in time order.
+	std::vector<tlog_index> indexs;
+	int evicted;
 };
 
 struct thistory_log {
@@ -272,11 +301,36 @@ struct thistory_log {
 };
 extern std::set<thistory_log> history_logs;
 
+struct tsearch_hit {
+	tsearch_hit(const std::string& receiver, bool journal, int offset, time_t t)
+		: receiver(receiver)
+		, journal(journal)
+		, offset(offset)
+		, t(t)
+	{}
+
+	std::string receiver;
+	// true: offset is in journal.log, false: offset is nth log of receiver in history.log.
+	bool journal;
+	int offset;
+	time_t t;
+};
+
+// find logs that contain all words of text. newest is first.
+void search(const std::string& text, std::vector<tsearch_hit>& hits, size_t max_hits = 200);
+
 treceiver& find_receiver(int id, bool channel, bool allow_create = false);
 void add(int id, bool channel, const tlobby_user& sender, const std::string& msg);
 
+// seal open logs. force: seal all, else only these can not be merged again.
+void flush(bool force);
+
 void restore_from_logfile();
 void user_from_logfile(const thistory_log& user, std::vector<tlog>& logs);
+// offset of every log of this user in history.log.
+void offsets_from_logfile(const thistory_log& user, std::vector<int>& offsets);
+// [start, end] are index of offsets.
+void logs_from_logfile(const thistory_log& user, const std::vector<int>& offsets, int start, int end, std::vector<tlog>& logs);
 void save_temp_logfile();
 void combine_logfile();
 
@@ -300,6 +354,8 @@ public:
 		virtual bool handle_raw(int at, tsock::ttype type, const char* param[]) { return false; }
 		virtual bool handle_raw2(int at, tsock::ttype type, const char* data, int len) { return false; }
 		virtual bool handle(int tag, tsock::ttype type, const config& data) { return false; }
+		// called at end of every tlobby::pump, batch ui update of this pump here.
+		virtual void handle_pump() {}
 		void join();
 
 	private:
@@ -414,6 +470,9 @@ public:
 		
 		Uint32 last_task_time_;
 		Uint32 task_threshold_;
+
+		// raw_data_[0, line_start_) has been dispatched.
+		int line_start_;
 	};
 
 	class thttp_sock: public tsock
@@ -438,15 +497,19 @@ public:
 		};
 
 		static int http_2_cfg(const char* http, const int size, config& cfg);
+		// value of header field name, nullptr if not exist. header is [http, http + size).
+		static const char* find_header_field(const char* http, const int size, const char* name, int& len);
 
-		thttp_sock()
-			: tsock(tag_http)
-			, progress_(nullptr)
-			, response_size_(0)
-		{}
+		enum {parse_header, parse_body, parse_chunk_size, parse_chunk_data, parse_chunk_crlf, parse_chunk_trailer, parse_done};
+		enum {encoding_identity, encoding_gzip, encoding_deflate};
+
+		thttp_sock();
+		~thttp_sock();
 		void process();
 		bool ready() const { return socket_.get() != nullptr; }
 		void reset_connect();
+		// current connection can carry next request, no need of re-handshake.
+		bool reusable() const;
 
 		virtual std::string form_url(const std::string& task) const { return task; }
 		virtual std::string form_request(const std::string& task, size_t content_length) const;
@@ -455,17 +518,44 @@ public:
 		bool network_receive_dialog(display& disp, int hidden_ms = 3);
 		bool network_send_dialog(display& disp, const char* buf, int len, int hidden_ms = 3);
 
+		// response is header block followed by decoded body.
 		int response_size() const { return response_size_; }
-		const char* response_buf() const { return response_size_? raw_data_: nullptr; }
+		const char* response_buf() const { return response_size_? &response_[0]: nullptr; }
 
 	private:
 		void mini_connectd() override;
 		void mini_read() override;
 		void mini_close(int err) override;
 
+		void reset_response();
+		bool parse_response();
+		bool parse_header_block();
+		bool append_body(const char* data, int len);
+		void finish_response();
+		void end_inflate();
+
 	private:
 		gui2::tprogress_* progress_;
 		int response_size_;
+
+		std::vector<char> response_;
+		int parse_state_;
+		// raw_data_[0, parse_offset_) has been parsed.
+		int parse_offset_;
+		// "\r\n\r\n" has been searched to this offset.
+		int header_scan_;
+		int header_size_;
+		// -1: until connection close.
+		int content_length_;
+		int body_received_;
+		int chunk_left_;
+		int encoding_;
+		z_stream_s* inflate_;
+		bool raw_deflate_;
+
+		bool keep_alive_;
+		Uint32 keep_alive_timeout_;
+		Uint32 last_response_ticks_;
 	};
 
 	class ttransit_sock: public tsock
@@ -1565,7 +1565,17 @@ static void irc_inline(server* serv, char* buf, int len)
 	char *pdibuf;
 	message_tags_data tags_data = MESSAGE_TAGS_DATA_INIT;
 
-	pdibuf = (char*)malloc(len + 1);
+	if (!serv->in_inline) {
+		// reuse one buffer, avoid malloc per line when NAMES/LIST flood.
+		if ((int)serv->pdibuf.size() < len + 1) {
+			serv->pdibuf.resize(std::max((int)serv->pdibuf.size() * 2, len + 1));
+		}
+		pdibuf = &serv->pdibuf[0];
+	} else {
+		pdibuf = (char*)malloc(len + 1);
+	}
+	const bool nested = serv->in_inline;
+	serv->in_inline = true;
 
 	sess = serv->sess_list.front();
 
@@ -1646,7 +1656,10 @@ static void irc_inline(server* serv, char* buf, int len)
 	}
 
 xit:
-	free(pdibuf);
+	serv->in_inline = nested;
+	if (nested) {
+		free(pdibuf);
+	}
 }
 
 void
@@ -1700,6 +1713,7 @@ server* server_new(const ircnet& net)
 
 	serv->id = id ++;
 	serv->sok = -1;
+	serv->in_inline = false;
 	strcpy (serv->nick, net.nick.c_str());
 
 	//
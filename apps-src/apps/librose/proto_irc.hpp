@@ -3,6 +3,7 @@
 
 #include <time.h>
 #include <list>
+#include <vector>
 #include <string>
 #include "ichat.hpp"
 
@@ -119,6 +120,9 @@ struct server
 	std::list<session*> sess_list;
 	ichat* sock;
 	const char* params[MAX_PARAMS];
+	// word buffer of p_inline, reused between lines.
+	std::vector<char> pdibuf;
+	bool in_inline;
 
 	/*  server control operations (in server*.c) */
 	void (*connect)(struct server *, char *hostname, int port, int no_login);
@@ -468,6 +468,20 @@ texture create_neutral_texture(const int w, const int h, const int access)
 	return result;
 }
 
+bool renderer_support_texture_format(SDL_Renderer* renderer, Uint32 format)
+{
+	SDL_RendererInfo info;
+	if (!renderer || SDL_GetRendererInfo(renderer, &info)) {
+		return false;
+	}
+	for (Uint32 n = 0; n < info.num_texture_formats; n ++) {
+		if (info.texture_formats[n] == format) {
+			return true;
+		}
+	}
+	return false;
+}
+
 surface create_optimized_surface(const surface &surf)
 {
 	if (surf == NULL) {
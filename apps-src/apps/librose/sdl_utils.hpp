@@ -157,6 +157,7 @@ surface create_neutral_surface(int w, int h);
 surface create_optimized_surface(const surface &surf);
 
 texture create_neutral_texture(const int w, const int h, const int access);
+bool renderer_support_texture_format(SDL_Renderer* renderer, Uint32 format);
 
 /**
  * Stretches a surface in the horizontal direction.
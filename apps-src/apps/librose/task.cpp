@@ -28,7 +28,7 @@ bool ttask::tsubtask::do_delete_path(display& disp, const std::set<std::string>&
 			continue;
 		}
 		symbols["name"] = path;
-		if (!SDL_DeleteFiles(path.c_str())) {
+		if (!delete_files(path)) {
 			gui2::show_message(disp.video(), null_str, vgettext2("Delete: $name fail!", symbols));
 			return false;
 		}
@@ -47,10 +47,10 @@ bool ttask::tsubtask::make_path(display& disp, const std::string& alias, bool de
 	}
 
 	std::string subpath = path.substr(0, pos);
-	SDL_MakeDirectory(subpath.c_str());
+	make_directory(subpath);
 
 	if (del) {
-		if (!SDL_DeleteFiles(path.c_str())) {
+		if (!delete_files(path)) {
 			symbols["type"] = _("Directory");
 			symbols["dst"] = path;
 			gui2::show_message(disp.video(), null_str, vgettext2("Delete $type, from $dst fail!", symbols));
@@ -93,6 +93,7 @@ int ttask::tsubtask::str_2_type(const std::string& str)
 
 ttask::tsubtask_copy::tsubtask_copy(ttask& task, const std::string& id, const config& cfg, std::map<std::string, std::string>& outer)
 	: tsubtask(task, id, cfg, outer)
+	, hash_(cfg["hash"].to_bool())
 {
 	std::vector<std::string> vstr2 = utils::split(cfg["function"].str());
 	VALIDATE(vstr2.size() == 3, null_str);
@@ -169,7 +170,7 @@ bool ttask::tsubtask_copy::fail_rollback(display& disp) const
 {
 	for (std::map<int, trollback>::const_iterator it = rollbacks_.begin(); it != rollbacks_.end(); ++ it) {
 		const trollback& rollback = it->second;
-		SDL_DeleteFiles(rollback.name.c_str()); // don't detect fail.
+		delete_files(rollback.name); // don't detect fail.
 	}
 	return true;
 }
@@ -228,7 +229,7 @@ bool ttask::tsubtask_copy::do_copy(display& disp, const std::string& src_alias,
 				resolve_res_2_rollback(r.type, dst);
 
 				std::string tmp = dst.substr(0, dst.rfind('/'));
-				SDL_MakeDirectory(tmp.c_str());
+				make_directory(tmp);
 
 			} else if (r.type == res_dir || r.type == res_files) {
 				if (!is_directory(src.c_str())) {
@@ -237,19 +238,15 @@ bool ttask::tsubtask_copy::do_copy(display& disp, const std::string& src_alias,
 
 				if (r.type == res_dir) {
 					resolve_res_2_rollback(r.type, dst);
-					// make sure system don't exsit dst! FO_COPY requrie it.
-					if (!SDL_DeleteFiles(dst.c_str())) {
-						symbols["type"] = _("Directory");
-						symbols["dst"] = dst;
-						gui2::show_message(disp.video(), null_str, vgettext2("Delete $type, from $dst fail!", symbols));
-						fok = false;
-						break;
-					}
 				}
 			}
-			if (r.type == res_file || r.type == res_dir) {
-				fok = SDL_CopyFiles(src.c_str(), dst.c_str());
-				if (fok && r.type == res_dir) {
+			if (r.type == res_file) {
+				fok = copy_files(src, dst);
+
+			} else if (r.type == res_dir) {
+				// only copy changed files, result is same as delete dst and then copy.
+				fok = sync_directory(src, dst, hash_);
+				if (fok) {
 					fok = compare_directory(src, dst);
 				}
 			} else {
@@ -258,7 +255,7 @@ bool ttask::tsubtask_copy::do_copy(display& disp, const std::string& src_alias,
 					// it is necessary to create directory, think res_dir.
 					resolve_res_2_rollback(res_dir, dst);
 					has_resolved = true;
-					SDL_MakeDirectory(dst.c_str());
+					make_directory(dst);
 				}
 				std::set<std::string> files;
 				fok = copy_root_files(src, dst, &files);
@@ -404,7 +401,7 @@ bool ttask::tsubtask_remove::do_remove(display& disp, const std::string& alias)
 				continue;
 			}
 		}
-		if (!SDL_DeleteFiles(dst.c_str())) {
+		if (!delete_files(dst)) {
 			symbols["type"] = r.type == res_file? _("File"): _("Directory");
 			symbols["dst"] = dst;
 			gui2::show_message(disp.video(), null_str, vgettext2("Delete $type, from $dst fail!", symbols));
@@ -486,7 +483,7 @@ bool ttask::tsubtask_rename::do_rename(display& disp, const std::string& alias)
 				continue;
 			}
 		}
-		if (!SDL_RenameFile(full_src.c_str(), actual_new_name.c_str())) {
+		if (!rename_file(full_src, actual_new_name)) {
 			symbols["type"] = r.type == res_file? _("File"): _("Directory");
 			symbols["src"] = full_src;
 			symbols["dst"] = actual_new_name;
@@ -779,10 +776,10 @@ bool ttask::make_path(display& disp, const std::string& tag, bool del) const
 	}
 
 	std::string subpath = path.substr(0, pos);
-	SDL_MakeDirectory(subpath.c_str());
+	make_directory(subpath);
 
 	if (del) {
-		if (!SDL_DeleteFiles(path.c_str())) {
+		if (!delete_files(path)) {
 			symbols["type"] = _("Directory");
 			symbols["dst"] = path;
 			gui2::show_message(disp.video(), null_str, vgettext2("Delete $type, from $dst fail!", symbols));
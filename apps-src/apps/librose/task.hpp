@@ -117,6 +117,8 @@ public:
 
 		std::vector<tres> copy_res_;
 		std::set<std::string> require_delete_;
+		// when sync directory, compare content besides size/mtime.
+		bool hash_;
 
 		struct trollback {
 			trollback(const res_type type, const std::string& name)
@@ -26,6 +26,7 @@
 #include "tstring.hpp"
 #include "gettext.hpp"
 #include "log.hpp"
+#include "thread.hpp"
 #include <boost/functional/hash.hpp>
 
 static lg::log_domain log_config("config");
@@ -42,6 +43,41 @@ namespace {
 
 	std::vector<std::string> id_to_textdomain;
 	std::map<std::string, unsigned int> textdomain_to_id;
+
+	// translated parts shared by all t_string, dropped when language changed.
+	// t_string maybe translated in worker thread, so every shard has a mutex.
+	struct ttranslation_shard
+	{
+		ttranslation_shard()
+			: mutex()
+			, language(0)
+			, translations()
+		{}
+
+		threading::mutex mutex;
+		unsigned language;
+		std::map<std::pair<std::string, std::string>, std::string> translations;
+	};
+	const int translation_shards = 16;
+	ttranslation_shard translation_cache[translation_shards];
+}
+
+static void append_translation(std::string& result, const std::string& textdomain, const std::string& msgid)
+{
+	ttranslation_shard& shard = translation_cache[boost::hash<std::string>()(msgid) % translation_shards];
+	threading::lock lock(shard.mutex);
+
+	if (shard.language != language_counter) {
+		shard.translations.clear();
+		shard.language = language_counter;
+	}
+
+	const std::pair<std::string, std::string> key(textdomain, msgid);
+	std::map<std::pair<std::string, std::string>, std::string>::const_iterator it = shard.translations.find(key);
+	if (it == shard.translations.end()) {
+		it = shard.translations.insert(std::make_pair(key, std::string(dsgettext(textdomain.c_str(), msgid.c_str())))).first;
+	}
+	result += it->second;
 }
 
 size_t t_string_base::hash_value() const {
@@ -424,28 +460,22 @@ bool t_string_base::operator<(const t_string_base &that) const
 	return value_ < that.value_;
 }
 
-const std::vector<t_string_base::trans_str>& t_string_base::valuex() const
+std::vector<t_string_base::trans_str> t_string_base::valuex() const
 {
-	static std::vector<trans_str>	t;
-	trans_str				ti;
-
-	t.clear();
+	std::vector<trans_str> t;
 
 	if (translatable_) {
 		for(walker w(*this); !w.eos(); w.next()) {
-			std::string part(w.begin(), w.end());
-
+			t.push_back(trans_str());
+			trans_str& ti = t.back();
+			ti.str.assign(w.begin(), w.end());
 			if(w.translatable()) {
-				ti.str = part;
 				ti.td = w.textdomain();
-			} else {
-				ti.str = part;
 			}
-			t.push_back(ti);
 		}
 	} else {
-		ti.str = value_;
-		t.push_back(ti);
+		t.push_back(trans_str());
+		t.back().str = value_;
 	}
 	return t;
 }
@@ -464,7 +494,7 @@ const std::string& t_string_base::str() const
 		std::string part(w.begin(), w.end());
 
 		if(w.translatable()) {
-			translated_value_ += dsgettext(w.textdomain().c_str(), part.c_str());
+			append_translation(translated_value_, w.textdomain(), part);
 		} else {
 			translated_value_ += part;
 		}
@@ -1477,7 +1477,7 @@ bool tremover::app_post_handle(display& disp, const tsubtask& subtask, const boo
 	for (std::set<std::string>::const_iterator it = tdomains_.begin(); it != tdomains_.end(); ++ it) {
 		for (std::vector<std::string>::const_iterator it2 = languages.begin(); it2 != languages.end(); ++ it2) {
 			const std::string file = game_config::path + "/translations/" + *it2 + "/LC_MESSAGES/" + *it + ".mo";
-			SDL_DeleteFiles(file.c_str());
+			delete_files(file);
 		}
 	}
 
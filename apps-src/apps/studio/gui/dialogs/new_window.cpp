@@ -254,14 +254,11 @@ void tnew_window::did_id_changed(twindow& window, ttext_box& widget)
 	}
 	if (active) {
 		// must not registed window.
-		const std::map<std::string, twindow_builder>& window_types = gui.window_types;
+		const std::map<std::string, const config*>& window_cfgs = gui.window_cfgs;
 
 		const std::string key = utils::generate_app_prefix_id(app_.app, id);
-		for (std::map<std::string, twindow_builder>::const_iterator it = window_types.begin(); it != window_types.end(); ++ it) {
-			if (it->first == key) {
-				active = false;
-				break;
-			}
+		if (window_cfgs.find(key) != window_cfgs.end()) {
+			active = false;
 		}
 	}
 
@@ -546,7 +546,7 @@ void trose::do_remove_dialog(tapp_copier& copier, const std::string& id, bool sc
 
 	for (std::vector<std::string>::const_iterator it = files.begin(); it != files.end(); ++ it) {
 		const std::string& file = *it;
-		SDL_DeleteFiles(file.c_str());
+		delete_files(file);
 	}
 }
 
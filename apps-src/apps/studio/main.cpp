@@ -8,6 +8,7 @@
 #include "gui/dialogs/combo_box.hpp"
 #include "gui/dialogs/design.hpp"
 #include "gui/widgets/window.hpp"
+#include "gui/widgets/settings.hpp"
 #include "game_end_exceptions.hpp"
 #include "wml_exception.hpp"
 #include "gettext.hpp"
@@ -52,6 +53,9 @@ void game_instance::start_mkwin(const std::map<std::string, std::string>& app_td
 	display_lock lock(disp());
 	hotkey::scope_changer changer(game_config(), "hotkey_mkwin");
 
+	// mkwin enumerates all control definitions.
+	gui2::gui.resolve_all_control_definitions();
+
 	display::initial_zoom = 64 * gui2::twidget::hdpi_scale;
 	mkwin_controller mkwin(game_config(), video_, app_tdomains);
 	mkwin.initialize();
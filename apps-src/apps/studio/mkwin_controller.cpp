@@ -231,6 +231,7 @@ const int mkwin_controller::default_child_width = 5;
 const int mkwin_controller::default_child_height = 4;
 const int mkwin_controller::default_dialog_width = 48;
 const int mkwin_controller::default_dialog_height = 24;
+const size_t mkwin_controller::max_undo_snapshots = 32;
 
 std::string mkwin_controller::widget_template_cfg()
 {
@@ -312,6 +313,7 @@ void mkwin_controller::app_post_initialize()
 {
 	fill_spacer(NULL, -1);
 	units_.save_map_to(top_, false);
+	record_snapshot();
 
 	set_status();
 	gui_->show_context_menu();
@@ -422,9 +424,18 @@ void mkwin_controller::app_execute_command(int command, const std::string& spara
 			system();
 			break;
 
+		case HOTKEY_UNDO:
+			undo();
+			return;
+		case HOTKEY_REDO:
+			redo();
+			return;
+
 		default:
 			base_controller::app_execute_command(command, sparam);
 	}
+	// if command doesn't modify window, snapshot is same as current and will be discarded.
+	record_snapshot();
 }
 
 void mkwin_controller::insert_row(unit* u, bool top)
@@ -452,6 +463,9 @@ void mkwin_controller::insert_row(unit* u, bool top)
 		std::advance(it, row);
 	}
 	child.rows.insert(it, new unit(*this, *gui_, units_, unit::ROW, parent.u, parent.number));
+	if (parent.u) {
+		parent.u->touch();
+	}
 
 	layout_dirty();
 	gui_->show_context_menu();
@@ -480,6 +494,9 @@ void mkwin_controller::erase_row(unit* u)
 		std::advance(it, row);
 	}
 	child.rows.erase(it);
+	if (parent.u) {
+		parent.u->touch();
+	}
 
 	layout_dirty();
 
@@ -515,6 +532,9 @@ void mkwin_controller::insert_column(unit* u, bool left)
 		std::advance(it, col);
 	}
 	child.cols.insert(it, new unit(*this, *gui_, units_, unit::COLUMN, parent.u, parent.number));
+	if (parent.u) {
+		parent.u->touch();
+	}
 
 	layout_dirty();
 	gui_->show_context_menu();
@@ -544,6 +564,9 @@ void mkwin_controller::erase_column(unit* u)
 		std::advance(it, col);
 	}
 	child.cols.erase(it);
+	if (parent.u) {
+		parent.u->touch();
+	}
 
 	layout_dirty();
 	if (col >= (int)child.cols.size()) {
@@ -724,6 +747,7 @@ void mkwin_controller::linked_group_setting(unit* u)
 	}
 
 	linked_groups = dlg.linked_groups();
+	u->touch();
 }
 
 void mkwin_controller::copy_widget(unit* u, bool cut)
@@ -1376,6 +1400,9 @@ void mkwin_controller::load_window()
 	// window_cfg is format from *.cfg directly that parsed macro.
 	// here requrie format that is tpl_widget.
 	original_.second = generate_window_cfg().child("window");
+
+	clear_snapshots();
+	record_snapshot();
 }
 
 void mkwin_controller::save_window(bool as)
@@ -1629,6 +1656,9 @@ void mkwin_controller::replace_child_unit(unit* u)
 	int pitch = (u->get_location().y - 1 - window_loc.y) * child.cols.size();
 	int at = pitch + u->get_location().x - 1 - window_loc.x;
 	child.units[at] = u;
+	if (parent.u) {
+		parent.u->touch();
+	}
 }
 
 void mkwin_controller::app_left_mouse_down(const int x, const int y, const bool minimap)
@@ -1678,6 +1708,7 @@ void mkwin_controller::app_left_mouse_down(const int x, const int y, const bool
 
 	if (valid) {
 		fill_object_list();
+		record_snapshot();
 	}
 	gui_->show_context_menu();
 }
@@ -1926,6 +1957,135 @@ config mkwin_controller::generate_window_cfg() const
 	return top;
 }
 
+mkwin_controller::tsnapshot_cell_ptr mkwin_controller::snapshot_cell(const unit& u, std::map<int, tsnapshot_cell_ptr>& cells) const
+{
+	std::map<int, tsnapshot_cell_ptr>::const_iterator it = snapshot_cells_.find(u.revision());
+	tsnapshot_cell_ptr cell;
+	if (it != snapshot_cells_.end()) {
+		cell = it->second;
+	} else {
+		cell = new tsnapshot_cell(u.revision());
+		u.generate(cell->cfg);
+	}
+	cells.insert(std::make_pair(u.revision(), cell));
+	return cell;
+}
+
+void mkwin_controller::record_snapshot()
+{
+	if (preview_) {
+		return;
+	}
+
+	tsnapshot snapshot;
+	std::map<int, tsnapshot_cell_ptr> cells;
+
+	config& window_cfg = snapshot.window;
+	top_.window->generate(window_cfg);
+	for (std::vector<unit*>::const_iterator it = top_.rows.begin(); it != top_.rows.end(); ++ it) {
+		snapshot.rows.push_back(snapshot_cell(**it, cells));
+	}
+	for (std::vector<unit*>::const_iterator it = top_.cols.begin(); it != top_.cols.end(); ++ it) {
+		snapshot.cols.push_back(snapshot_cell(**it, cells));
+	}
+	for (std::vector<unit*>::const_iterator it = top_.units.begin(); it != top_.units.end(); ++ it) {
+		snapshot.units.push_back(snapshot_cell(**it, cells));
+	}
+	snapshot_cells_.swap(cells);
+
+	if (!undo_stack_.empty() && undo_stack_.back() == snapshot) {
+		return;
+	}
+	undo_stack_.push_back(snapshot);
+	if (undo_stack_.size() > max_undo_snapshots) {
+		undo_stack_.pop_front();
+	}
+	redo_stack_.clear();
+}
+
+void mkwin_controller::restore_snapshot(const tsnapshot& snapshot)
+{
+	VALIDATE(!preview_, null_str);
+
+	// same as generate_window_cfg
+	config window_cfg = snapshot.window;
+	config& res_cfg = window_cfg.child("resolution");
+	config& top_grid = res_cfg.add_child("grid");
+
+	const int rows = (int)snapshot.rows.size();
+	const int cols = (int)snapshot.cols.size();
+	for (int y = 0; y < rows; y ++) {
+		config& row_cfg = top_grid.add_child("row", snapshot.rows[y]->cfg);
+		for (int x = 0; x < cols; x ++) {
+			config& column_cfg = row_cfg.add_child("column", snapshot.units[y * cols + x]->cfg);
+			if (!y) {
+				column_cfg.merge_attributes(snapshot.cols[x]->cfg);
+			}
+		}
+	}
+
+	// units will be deleted.
+	set_copied_unit(NULL);
+	{
+		tused_widget_tpl_lock tpl_lock(*this);
+
+		top_.erase(units_);
+		top_.from(*this, *gui_, units_, NULL, -1, top_grid);
+		top_.window->from(window_cfg);
+		form_linked_groups(res_cfg);
+		form_context_menus(res_cfg);
+		form_float_widgets(res_cfg);
+
+		layout_dirty();
+	}
+
+	// new units have same content with snapshot, let next record share cells.
+	snapshot_cells_.clear();
+	for (int n = 0; n < rows; n ++) {
+		top_.rows[n]->set_revision(snapshot.rows[n]->revision);
+		snapshot_cells_.insert(std::make_pair(snapshot.rows[n]->revision, snapshot.rows[n]));
+	}
+	for (int n = 0; n < cols; n ++) {
+		top_.cols[n]->set_revision(snapshot.cols[n]->revision);
+		snapshot_cells_.insert(std::make_pair(snapshot.cols[n]->revision, snapshot.cols[n]));
+	}
+	for (int n = 0; n < (int)snapshot.units.size(); n ++) {
+		top_.units[n]->set_revision(snapshot.units[n]->revision);
+		snapshot_cells_.insert(std::make_pair(snapshot.units[n]->revision, snapshot.units[n]));
+	}
+
+	fill_object_list();
+	selected_hex_ = map_location();
+	gui_->show_context_menu();
+}
+
+void mkwin_controller::clear_snapshots()
+{
+	undo_stack_.clear();
+	redo_stack_.clear();
+	snapshot_cells_.clear();
+}
+
+void mkwin_controller::undo()
+{
+	if (!can_undo()) {
+		return;
+	}
+	redo_stack_.push_back(undo_stack_.back());
+	undo_stack_.pop_back();
+	restore_snapshot(undo_stack_.back());
+}
+
+void mkwin_controller::redo()
+{
+	if (!can_redo()) {
+		return;
+	}
+	undo_stack_.push_back(redo_stack_.back());
+	redo_stack_.pop_back();
+	restore_snapshot(undo_stack_.back());
+}
+
 std::vector<unit*> mkwin_controller::form_top_units() const
 {
 	std::vector<unit*> result;
@@ -2101,6 +2261,10 @@ bool mkwin_controller::in_context_menu(const std::string& id) const
 		return preview_ || !selected_hex_.valid();
 	case HOTKEY_SYSTEM:
 		return !selected_hex_.valid() && !preview_;
+	case HOTKEY_UNDO:
+		return !selected_hex_.valid() && can_undo();
+	case HOTKEY_REDO:
+		return !selected_hex_.valid() && can_redo();
 
 	case tmkwin_scene::HOTKEY_SETTING: // setting
 		return !preview_ && u && (u->type() != unit::WINDOW || (!u->parent().u || u->parent().u->is_stack()));
@@ -22,6 +22,9 @@
 #include "unit_map.hpp"
 #include "map.hpp"
 #include "gui/auxiliary/window_builder.hpp"
+#include "reference_counted_object.hpp"
+
+#include <deque>
 
 class mkwin_controller;
 
@@ -88,6 +91,34 @@ public:
 	static const int default_dialog_height;
 
 	static std::string widget_template_cfg();
+	static const size_t max_undo_snapshots;
+
+	// undo snapshot. generated cfg of every top-level unit is shared between snapshots,
+	// a edit only regenerate top-level unit that holds modified unit.
+	struct tsnapshot_cell: public reference_counted_object
+	{
+		tsnapshot_cell(int revision)
+			: revision(revision)
+			, cfg()
+		{}
+
+		int revision;
+		config cfg;
+	};
+	typedef boost::intrusive_ptr<tsnapshot_cell> tsnapshot_cell_ptr;
+
+	struct tsnapshot
+	{
+		bool operator==(const tsnapshot& that) const
+		{
+			return rows == that.rows && cols == that.cols && units == that.units && window == that.window;
+		}
+
+		config window;
+		std::vector<tsnapshot_cell_ptr> rows;
+		std::vector<tsnapshot_cell_ptr> cols;
+		std::vector<tsnapshot_cell_ptr> units;
+	};
 
 	class tused_widget_tpl_lock
 	{
@@ -190,6 +221,10 @@ public:
 
 	void insert_used_widget_tpl(const config& tpl_cfg);
 
+	void record_snapshot();
+	bool can_undo() const { return !preview_ && undo_stack_.size() >= 2; }
+	bool can_redo() const { return !preview_ && !redo_stack_.empty(); }
+
 	void form_linked_groups(const config& res_cfg);
 	void generate_linked_groups(config& res_cfg) const;
 
@@ -261,6 +296,12 @@ private:
 
 	std::vector<std::string> generate_textdomains(const std::string& file, bool scene) const;
 
+	tsnapshot_cell_ptr snapshot_cell(const unit& u, std::map<int, tsnapshot_cell_ptr>& cells) const;
+	void restore_snapshot(const tsnapshot& snapshot);
+	void clear_snapshots();
+	void undo();
+	void redo();
+
 private:
 	/** The display object used and owned by the editor. */
 	mkwin_display* gui_;
@@ -297,6 +338,11 @@ private:
 	std::set<const config*> used_widget_tpl_;
 
 	std::map<std::string, std::string> app_tdomains_;
+
+	// back of undo_stack_ is current state.
+	std::deque<tsnapshot> undo_stack_;
+	std::vector<tsnapshot> redo_stack_;
+	std::map<int, tsnapshot_cell_ptr> snapshot_cells_;
 };
 
 #endif
@@ -31,6 +31,7 @@ extern std::string noise_config_key(const std::string& key);
 extern std::string noise_config_key_tpl(const std::string& key, const std::string& id);
 
 const std::string unit::widget_prefix = "widget/";
+int unit::next_revision_ = 0;
 const std::string unit::tpl_type = "tpl";
 const std::string unit::tpl_widget_prefix = "tpl-";
 const std::string unit::tpl_id_prefix = "_tpl_";
@@ -89,6 +90,7 @@ unit::unit(mkwin_controller& controller, mkwin_display& disp, unit_map& units, c
 	, widget_(widget)
 	, type_(WIDGET)
 	, parent_(tparent(parent, number))
+	, revision_(++ next_revision_)
 {
 	if (widget_.second && widget_.second->text_font_size) {
 		cell_.widget.text_font_size = font::default_relative_size;
@@ -103,6 +105,7 @@ unit::unit(mkwin_controller& controller, mkwin_display& disp, unit_map& units, i
 	, widget_()
 	, type_(type)
 	, parent_(tparent(parent, number))
+	, revision_(++ next_revision_)
 {
 	if (type == WINDOW && !parent) {
 		cell_.id = gui2::untitled;
@@ -118,6 +121,7 @@ unit::unit(const unit& that)
 	, parent_(that.parent_)
 	, widget_(that.widget_)
 	, cell_(that.cell_)
+	, revision_(++ next_revision_)
 {
 	// caller require call set_parent to set self-parent.
 
@@ -190,43 +194,46 @@ void unit::redraw_widget(int xsrc, int ysrc, int width, int height) const
 		blit2.height = height / 4;
 	}
 
-	surface text_surf;
 	if (!cell_.id.empty()) {
-		surface text_surf = font::get_rendered_text2(cell_.id, -1, 10 * gui2::twidget::hdpi_scale, font::BLACK_COLOR);
-		if (text_surf->w > width) {
-			SDL_Rect r = create_rect(0, 0, width, text_surf->h);
-			text_surf = cut_surface(text_surf, r); 
-		}
-		disp_.drawing_buffer_add(display::LAYER_UNIT_DEFAULT,
-			loc_, xsrc, ysrc + height / 2, text_surf, 0, 0);
+		draw_label(label_surface(label_id, cell_.id, font::BLACK_COLOR), xsrc, ysrc + height / 2, width);
 	}
 	if (!cell_.widget.label.empty()) {
-		text_surf = font::get_rendered_text2(cell_.widget.label, -1, 10 * gui2::twidget::hdpi_scale, font::BLUE_COLOR);
-		if (text_surf->w > width) {
-			SDL_Rect r = create_rect(0, 0, width, text_surf->h);
-			text_surf = cut_surface(text_surf, r); 
-		}
-		disp_.drawing_buffer_add(display::LAYER_UNIT_DEFAULT,
-			loc_, xsrc, ysrc + height - text_surf->h, text_surf, 0, 0);
+		const surface& text_surf = label_surface(label_label, cell_.widget.label, font::BLUE_COLOR);
+		draw_label(text_surf, xsrc, ysrc + height - text_surf->h, width);
 	}
 
 	if (is_spacer() && (!cell_.widget.width.empty() || !cell_.widget.height.empty())) {
-		if (!cell_.widget.width.empty()) {
-			text_surf = font::get_rendered_text2(cell_.widget.width, -1, 10 * gui2::twidget::hdpi_scale, font::BAD_COLOR);
-		} else {
-			text_surf = font::get_rendered_text2("--", -1, 10 * gui2::twidget::hdpi_scale, font::BAD_COLOR);
-		}
-		disp_.drawing_buffer_add(display::LAYER_UNIT_DEFAULT,
-			loc_, xsrc, ysrc + height - 2 * text_surf->h, text_surf, 0, 0);
+		const surface& width_surf = label_surface(label_width, cell_.widget.width.empty()? "--": cell_.widget.width, font::BAD_COLOR);
+		draw_label(width_surf, xsrc, ysrc + height - 2 * width_surf->h, width_surf->w);
 
-		if (!cell_.widget.height.empty()) {
-			text_surf = font::get_rendered_text2(cell_.widget.height, -1, 10 * gui2::twidget::hdpi_scale, font::BAD_COLOR);
-		} else {
-			text_surf = font::get_rendered_text2("--", -1, 10 * gui2::twidget::hdpi_scale, font::BAD_COLOR);
-		}
-		disp_.drawing_buffer_add(display::LAYER_UNIT_DEFAULT,
-			loc_, xsrc, ysrc + height - text_surf->h, text_surf, 0, 0);
+		const surface& height_surf = label_surface(label_height, cell_.widget.height.empty()? "--": cell_.widget.height, font::BAD_COLOR);
+		draw_label(height_surf, xsrc, ysrc + height - height_surf->h, height_surf->w);
+	}
+}
+
+const surface& unit::label_surface(int at, const std::string& text, const SDL_Color& color) const
+{
+	const int font_size = 10 * gui2::twidget::hdpi_scale;
+	tlabel_surface& label = label_surfaces_[at];
+	if (!label.surf || label.text != text || label.font_size != font_size ||
+		label.color.r != color.r || label.color.g != color.g || label.color.b != color.b || label.color.a != color.a) {
+		label.text = text;
+		label.font_size = font_size;
+		label.color = color;
+		label.surf = font::get_rendered_text2(text, -1, font_size, color);
 	}
+	return label.surf;
+}
+
+void unit::draw_label(const surface& surf, int x, int y, int max_width) const
+{
+	if (!surf) {
+		return;
+	}
+	// clip by source rect, don't cut_surface a new one every redraw.
+	const int w = std::min(surf->w, max_width);
+	disp_.drawing_buffer_add(display::LAYER_UNIT_DEFAULT,
+		loc_, x, y, surf, w, surf->h, create_rect(0, 0, w, surf->h));
 }
 
 void unit::draw_unit()
@@ -388,6 +395,13 @@ void unit::set_cell(const gui2::tcell_setting& cell)
 	if (is_grid()) {
 		children_[0].window->cell().id = cell_.id;
 	}
+	touch();
+}
+
+void unit::touch()
+{
+	unit* top = const_cast<unit*>(parent_at_top());
+	top->revision_ = ++ next_revision_;
 }
 
 void unit::set_child(int number, const tchild& child)
@@ -454,6 +468,7 @@ void unit::insert_child(int w, int h)
 		}
 	}
 	children_.push_back(child);
+	touch();
 }
 
 void unit::erase_child(int index)
@@ -478,6 +493,7 @@ void unit::erase_child(int index)
 			u->set_parent_number(n);
 		}
 	}
+	touch();
 }
 
 void unit::insert_listbox_child(int w, int h)
@@ -507,6 +523,7 @@ void unit::insert_listbox_child(int w, int h)
 	}
 	VALIDATE(child.cols.size() * child.rows.size() == child.units.size(), "count of unit mistake!");
 	children_.push_back(child);
+	touch();
 }
 
 void unit::insert_treeview_child()
@@ -534,6 +551,7 @@ void unit::insert_treeview_child()
 
 	VALIDATE(child.cols.size() * child.rows.size() == child.units.size(), "count of unit mistake!");
 	children_.push_back(child);
+	touch();
 }
 
 std::string unit::child_tag(int index) const
@@ -183,7 +183,30 @@ public:
 
 	bool is_tpl() const;
 
+	// revision of top-level unit identifies its content in undo snapshot.
+	int revision() const { return revision_; }
+	void set_revision(int revision) { revision_ = revision; }
+	void touch();
+
 protected:
+	enum {label_id, label_label, label_width, label_height, label_count};
+	struct tlabel_surface
+	{
+		tlabel_surface()
+			: text()
+			, font_size(0)
+			, color()
+			, surf()
+		{}
+
+		std::string text;
+		int font_size;
+		SDL_Color color;
+		surface surf;
+	};
+	const surface& label_surface(int at, const std::string& text, const SDL_Color& color) const;
+	void draw_label(const surface& surf, int x, int y, int max_width) const;
+
 	void redraw_widget(int xsrc, int ysrc, int width, int height) const;
 
 	void generate_main_map_border(config& cfg) const;
@@ -229,6 +252,12 @@ protected:
 	std::pair<std::string, gui2::tcontrol_definition_ptr> widget_;
 	gui2::tcell_setting cell_;
 	std::vector<tchild> children_;
+
+	static int next_revision_;
+	int revision_;
+
+	// rendered text of redraw_widget, re-render only when text/size/color changed.
+	mutable tlabel_surface label_surfaces_[label_count];
 };
 
 std::string formual_extract_str(const std::string& str);
@@ -25,6 +25,7 @@
 unit_map::unit_map(mkwin_controller& controller, const tmap& gmap, bool consistent)
 	: base_map(controller, gmap, consistent)
 	, controller_(controller)
+	, placements_(NULL)
 {
 }
 
@@ -172,7 +173,7 @@ void unit_map::restore_map_from(const unit::tchild& child, const int xstart, con
 {
 	const int serial_gap = 1;
 	if (create) {
-		VALIDATE(xstart || ystart || !map_vsize_, "map_vsize_ must be 0.");
+		VALIDATE(xstart || ystart || !map_vsize_ || placements_, "map_vsize_ must be 0.");
 	}
 
 	unit* window = child.window;
@@ -183,12 +184,12 @@ void unit_map::restore_map_from(const unit::tchild& child, const int xstart, con
 		int h = (int)child.rows.size();
 		
 		if (create) {
-			insert(map_location(xstart, ystart), window);
+			layout_insert(map_location(xstart, ystart), window);
 			for (int x = 0; x < w; x ++) {
-				insert(map_location(xstart + x + 1, ystart), child.cols[x]);
+				layout_insert(map_location(xstart + x + 1, ystart), child.cols[x]);
 			}
 			for (int y = 0; y < h; y ++) {
-				insert(map_location(xstart, ystart + y + 1), child.rows[y]);
+				layout_insert(map_location(xstart, ystart + y + 1), child.rows[y]);
 			}
 		}
 		int uindex = 0;
@@ -199,7 +200,7 @@ void unit_map::restore_map_from(const unit::tchild& child, const int xstart, con
 			for (int x = 1; x <= w; x ++) {
 				unit* u = child.units[uindex ++];
 				if (create) {
-					insert(map_location(xstart + x, ystart + y), u);
+					layout_insert(map_location(xstart + x, ystart + y), u);
 				}
 				const std::vector<unit::tchild>& children = u->children();
 				
@@ -292,12 +293,34 @@ void unit_map::zero_map()
 	}
 }
 
+void unit_map::layout_insert(const map_location& loc, unit* u)
+{
+	if (placements_) {
+		placements_->push_back(std::make_pair(loc, u));
+	} else {
+		insert(loc, u);
+	}
+}
+
 void unit_map::layout(const unit::tchild& child)
 {
-	zero_map();
 	if (controller_.preview()) {
+		zero_map();
 		restore_map_from(controller_.current_unit()->children(), true);
-	} else {
+		return;
+	}
+
+	// only units whose location changed are moved, don't zero and insert one by one,
+	// insert will sort_map every time.
+	std::vector<std::pair<map_location, base_unit*> > placements;
+	placements_ = &placements;
+	restore_map_from(child, 0, 0, true);
+	placements_ = NULL;
+
+	relocate(placements);
+	if (map_vsize_ != (int)placements.size()) {
+		// there is unit not in tree, rebuild whole map.
+		zero_map();
 		restore_map_from(child, 0, 0, true);
 	}
 }
@@ -47,8 +47,13 @@ public:
 
 	bool line_is_spacer(bool row, int index) const;
 
+private:
+	void layout_insert(const map_location& loc, unit* u);
+
 private:
 	mkwin_controller& controller_;
+	// when not NULL, restore_map_from only collects locations, layout will relocate in batch.
+	std::vector<std::pair<map_location, base_unit*> >* placements_;
 };
 
 #endif